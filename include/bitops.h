@@ -0,0 +1,106 @@
+#ifndef _BITOPS_H
+#define _BITOPS_H
+
+#include "da_types.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//	Number of bits in one bitmap word.
+const int BITS_PER_WORD = 8 * sizeof(uint);
+
+//	Number of bitmap words needed to hold the given number of bits.
+inline int BitmapWords(int numOfBits)
+{
+	return (numOfBits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+//	Count the bits that are set in the word.
+inline int PopCount(uint word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcount(word);
+#else
+	word = word - ((word >> 1) & 0x55555555);
+	word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+	return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+//	Get the index of the lowest bit set in the word, which must not be 0.
+inline int CountTrailingZeros(uint word)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz(word);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, word);
+	return (int)index;
+#else
+	int count = 0;
+	while ((word & 1) == 0) {
+		word >>= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+//	Find the first set bit at or after bit from in a bitmap of numOfBits
+//	bits, whose unused high bits are clear. Returns numOfBits if none.
+inline int FindSetBit(const uint *bitmap, int from, int numOfBits)
+{
+	if (from >= numOfBits) return numOfBits;
+
+	int numOfWords = BitmapWords(numOfBits);
+	int word = from / BITS_PER_WORD;
+	uint bits = bitmap[word] & (~0u << (from % BITS_PER_WORD));   // ignore bits before from
+	while (bits == 0) {
+		if (++word == numOfWords) return numOfBits;
+		bits = bitmap[word];
+	}
+	return word * BITS_PER_WORD + CountTrailingZeros(bits);
+}
+
+//	Find the first clear bit in a bitmap of numOfBits bits. Returns
+//	numOfBits if all are set.
+inline int FindClearBit(const uint *bitmap, int numOfBits)
+{
+	int numOfWords = BitmapWords(numOfBits);
+	for (int word = 0; word < numOfWords; word++) {
+		if (bitmap[word] != ~0u) {
+			int bit = word * BITS_PER_WORD + CountTrailingZeros(~bitmap[word]);
+			return (bit < numOfBits) ? bit : numOfBits;
+		}
+	}
+	return numOfBits;
+}
+
+//	Set or clear one bit of a bitmap.
+inline void SetBit(uint *bitmap, int bit)   { bitmap[bit / BITS_PER_WORD] |= 1u << (bit % BITS_PER_WORD); }
+inline void ClearBit(uint *bitmap, int bit) { bitmap[bit / BITS_PER_WORD] &= ~(1u << (bit % BITS_PER_WORD)); }
+inline bool TestBit(const uint *bitmap, int bit) { return (bitmap[bit / BITS_PER_WORD] & (1u << (bit % BITS_PER_WORD))) != 0; }
+
+//	Count the set bits of a bitmap.
+inline int CountBits(const uint *bitmap, int numOfBits)
+{
+	int numOfWords = BitmapWords(numOfBits);
+	int count = 0;
+	for (int word = 0; word < numOfWords; word++) {
+		count += PopCount(bitmap[word]);
+	}
+	return count;
+}
+
+//	Clear the bits of mask that are not set in bitmap, e.g. to drop
+//	matches in empty slots from a filter mask.
+inline void AndBits(uint *mask, const uint *bitmap, int numOfBits)
+{
+	int numOfWords = BitmapWords(numOfBits);
+	for (int word = 0; word < numOfWords; word++) {
+		mask[word] &= bitmap[word];
+	}
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _FILTER_H
+#define _FILTER_H
+
+#include "minirel.h"
+#include "predicate.h"
+
+//	Instruction sets the filter kernels may use.
+enum SimdLevel { SIMD_NONE, SIMD_SSE2, SIMD_AVX2 };
+
+//	Evaluate a condition on an attrInteger or attrReal field over count
+//	values lying stride bytes apart, starting at base. Bit i of mask is
+//	set when value i satisfies the condition; mask must hold
+//	BitmapWords(count) words. Only the type, op, low and high members of
+//	the condition are used. The comparisons run with AVX2 or SSE2 when
+//	the CPU has them, picked at run time, and in scalar code otherwise.
+//	Build the condition with Condition::Init.
+//	Returns FAIL if the type or operator is not supported.
+Status FilterColumn(const char *base, int stride, int count, const Condition& cond, uint *mask);
+
+//	Limit FilterColumn to the kernels of the given level and below, e.g.
+//	to check them against the scalar one. Levels the CPU lacks are never
+//	used. Returns the level that was in use.
+SimdLevel SetFilterSimdLevel(SimdLevel level);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef _FIXEDPAGE_H
+#define _FIXEDPAGE_H
+
+#include "heappage.h"
+#include "bitops.h"
+
+struct Condition;
+
+//	A HeapPage of fixed-length records. Instead of a slot per record, the
+//	data area holds an occupancy bitmap (one bit per record position),
+//	followed by the records themselves, so a record's address is computed
+//	directly from its slot number.
+//
+//	The page is tagged FIXED_LAYOUT in the header, and HeapPage's record
+//	operations forward to this class. Slot numbers are record positions;
+//	FixedHeader keeps how many records fit and how many are stored.
+//
+//	Data area: FixedHeader, the occupancy bitmap, then the records.
+class FixedPage : public HeapPage {
+
+protected :
+	struct FixedHeader
+	{
+		short recLen;		// Length of every record on this page.
+		short records;		// Offset of the first record in the data area.
+		short numOfSlots;	// Number of record positions on this page.
+		short numOfRecords;	// Number of records in this page (set bits).
+	};
+
+	FixedHeader* GetHeader() {
+		return (FixedHeader*)data;
+	}
+
+	//	Get the occupancy bitmap, which follows the header.
+	uint* GetBitmap() {
+		return (uint*)(data + sizeof(FixedHeader));
+	}
+
+	//	Check if the slot is empty.
+	bool SlotIsEmpty(int slotNo) {
+		return !TestBit(GetBitmap(), slotNo);
+	}
+
+	//	Get a pointer to the record in the given slot.
+	char* GetRecordPointer(int slotNo) {
+		return data + GetHeader()->records + slotNo * GetHeader()->recLen;
+	}
+
+public:
+	//	Inialize the page with given PageID, for records of the given length.
+	Status Init(PageID pageNo, int recLen);
+
+	//	Insert a record into the page.
+	Status InsertRecord(const char* recPtr, int recLen, RecordID& rid);
+
+	//	Delete a record from the page.
+	Status DeleteRecord(RecordID rid);
+
+	//	Overwrite a record on the page.
+	Status UpdateRecord(RecordID rid, const char* recPtr, int recLen);
+
+	//	To find the first record on a page.
+	Status FirstRecord(RecordID& firstRid);
+
+	//	To find the next record on a page.
+	Status NextRecord (RecordID curRid, RecordID& nextRid);
+
+	//	To retrieve a COPY of a record with ID rid from a page.
+	Status GetRecord(RecordID rid, char* recPtr, int& len);
+
+	//	To retrieve a POINTER to the record.
+	Status ReturnRecord(RecordID rid, char*& recPtr, int& len);
+
+	//	Evaluate a condition on a numeric field of every record on the page,
+	//	setting bit i of mask (BitmapWords(NumOfSlots()) words) when the
+	//	record in slot i exists and matches.
+	Status Filter(const Condition& cond, uint* mask);
+
+	//	To retrieve the occupancy bitmap, one bit per record position.
+	const uint* GetOccupancy() { return GetBitmap(); }
+
+	//	To return the amount of available space, in whole records.
+	int    AvailableSpace() { return (GetHeader()->numOfSlots - GetHeader()->numOfRecords) * GetHeader()->recLen; }
+
+	//	Check if there is any record in the page.
+	bool   IsEmpty() { return GetHeader()->numOfRecords == 0; }
+
+	//	Counts the number of records in the page.
+	int    GetNumOfRecords() { return GetHeader()->numOfRecords; }
+
+	//	Get the number of record positions on the page.
+	int    NumOfSlots() { return GetHeader()->numOfSlots; }
+};
+
+#endif
@@ -4,13 +4,24 @@
 #include "minirel.h"
 #include "page.h"
 
+class Predicate;
+
 const int INVALID_SLOT =  -1;
 
+//	Layouts of the data area of a HeapPage, kept in its type field.
+enum PageLayout {
+	ROW_LAYOUT,		// Slotted page of variable-length records.
+	PAX_LAYOUT,		// One minipage per attribute; see PaxPage.
+	FIXED_LAYOUT	// Bitmap-indexed fixed-length records; see FixedPage.
+};
+
 //	Size of the data array in the class HeapPage
 const int HEAPPAGE_DATA_SIZE = MAX_SPACE - 3 * sizeof(PageID) - 4 * sizeof(short);
 
 class HeapPage {
 
+	friend class HeapPageIterator;
+
 protected :
 	struct Slot 
 	{
@@ -18,10 +29,16 @@ protected :
 		short length;	// Length of the record.
 	};
 
-	short   numOfSlots;	// Number of slots available (maybe filled or empty).
-	short   freePtr;	// Offset from start of data area, where begins the free space for adding new records.
-	short   freeSpace;	// Amount of free space in bytes in this page.
-	short   type;		// Not used for HeapFile assignment, but will be used in B+-tree assignment.
+	//	The header takes the room of four shorts, as HeapFile and DirPage
+	//	expect, so the fields are packed into two words. A slot costs at
+	//	least 4 bytes, so a ROW_LAYOUT page never holds more than 1019 slots;
+	//	PaxPage and FixedPage keep their own counts in the data area.
+	unsigned int numOfSlots   : 10;	// Number of slots available (maybe filled or empty).
+	unsigned int numOfRecords : 10;	// Number of records in this page (non-empty slots).
+	unsigned int freePtr      : 12;	// Offset from start of data area, where begins the free space for adding new records.
+	unsigned int freeSpace    : 12;	// Amount of free space in bytes in this page.
+	signed int   freeSlot     : 11;	// Head of the list of empty slots, chained through their offset field.
+	unsigned int type         : 2;	// PageLayout of the data area.
 
 	PageID  pid;		// Page ID of this page  
 	PageID  nextPage;	// Page ID of the next page.
@@ -45,12 +62,27 @@ protected :
 	void SetSlotEmpty(Slot *slot) {
 		slot->length = INVALID_SLOT;
 	}
+
+	//	Push the empty slot onto the head of the free-slot list.
+	void PushFreeSlot(Slot *slot, int slotNo) {
+		slot->offset = freeSlot;
+		freeSlot = slotNo;
+	}
 	
 	//	Get the first slot pointer, which is lcoated in the end of data area.
 	Slot* GetFirstSlotPointer() {
 		return (Slot*)(data + HEAPPAGE_DATA_SIZE - sizeof(Slot));
 	}
 
+	//	Get the amount of free space between freePtr and the slot directory.
+	//	The rest of freeSpace is left behind by deleted records until Compact.
+	int ContiguousFreeSpace() {
+		return HEAPPAGE_DATA_SIZE - numOfSlots * (int)sizeof(Slot) - freePtr;
+	}
+
+	//	Slide all records to the start of the data area.
+	void Compact();
+
 public:
 	//	Inialize the page with given PageID.
 	void Init(PageID pageNo);
@@ -58,8 +90,14 @@ public:
 	//	Insert a record into the page.
 	Status InsertRecord(const char* recPtr, int recLen, RecordID& rid);
 	
+	//	Insert as many of the given records as fit into the page.
+	int    InsertRecords(const char* const* recPtrs, const int* recLens, int numOfRecs, RecordID* rids);
+
 	//	Delete a record from the page.
 	Status DeleteRecord(RecordID rid);
+
+	//	Replace a record on the page, keeping its Record ID.
+	Status UpdateRecord(RecordID rid, const char* recPtr, int recLen);
 	
 	//	To find the first record on a page.
 	Status FirstRecord(RecordID& firstRid);
@@ -98,4 +136,54 @@ public:
 	PageID PageNo();  
 };
 
+
+//	Maximum number of records in a RecordBatch.
+const int RECORD_BATCH_SIZE = 1024;
+
+//	A batch of records gathered from one or more pinned pages, returned
+//	by pointer like HeapPageIterator.
+struct RecordBatch
+{
+	int         numOfRecords;				// Number of records in the batch.
+	RecordID    rids[RECORD_BATCH_SIZE];		// Record IDs of the records.
+	const char *recPtrs[RECORD_BATCH_SIZE];	// Pointers to the records in their pages.
+	int         recLens[RECORD_BATCH_SIZE];	// Lengths of the records.
+
+	void Clear()  { numOfRecords = 0; }
+	bool IsFull() { return numOfRecords == RECORD_BATCH_SIZE; }
+};
+
+
+//	Walks the records of a HeapPage in slot order without copying them,
+//	skipping those that fail the predicate, if one is given.
+//	The pointers returned stay valid as long as the page stays pinned
+//	and no record is inserted, deleted or updated on it. Pages of
+//	ROW_LAYOUT and FIXED_LAYOUT can be walked this way; the rows of a
+//	PAX_LAYOUT page are split across minipages, so FillBatch returns FAIL
+//	on one, and GetStatus tells a NULL from operator() on one from a page
+//	that ran out of records.
+//
+//	FillBatch appends to what the batch already holds, so one batch can
+//	gather the records of several pages: on OK the batch is full and the
+//	caller drains it and calls again for the rest of the page, on DONE
+//	it moves on to the next page with the same batch.
+class HeapPageIterator
+{
+
+private :
+
+	int currSlot;
+	HeapPage *page;
+	const Predicate *pred;
+	Status status;
+
+public :
+
+	HeapPageIterator(HeapPage *page, const Predicate *pred = NULL);
+	~HeapPageIterator();
+	const char *operator() (RecordID& rid, int& len);
+	Status GetStatus() { return status; }
+	Status FillBatch(RecordBatch& batch);
+};
+
 #endif
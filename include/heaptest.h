@@ -22,6 +22,20 @@ private:
     bool Test5();
     bool Test6();
 
+    // Page checks run by Test6.
+    bool PageTestFreeSlots();
+    bool PageTestCompaction();
+    bool PageTestRecordCount();
+    bool PageTestUpdate();
+    bool PageTestInsertBatch();
+    bool PageTestFixed();
+    bool PageTestPredicate();
+    bool PageTestFilterKernels();
+    bool PageTestPax();
+    bool PageTestIterator();
+    bool PageTestBatch();
+    bool PageTestPushdown();
+
     Status RunAllTests();
     const char* TestName();
 };
@@ -0,0 +1,122 @@
+#ifndef _PAXPAGE_H
+#define _PAXPAGE_H
+
+#include "heappage.h"
+#include "bitops.h"
+
+struct Condition;
+
+//	Maximum number of attributes in a PaxPage schema.
+const int MAX_PAX_ATTRS = 16;
+
+//	Describes one attribute of the rows stored in a PaxPage.
+struct AttrDesc
+{
+	AttrType type;		// Type of the attribute.
+	int      offset;	// Offset of the attribute in the row.
+	int      length;	// Length of the attribute in bytes.
+};
+
+//	A HeapPage whose data area is split into one minipage per attribute
+//	(partition attributes across), for fixed-length rows of a declared
+//	schema. All values of an attribute lie back to back, so a scan that
+//	reads one attribute touches only that attribute's cache lines.
+//
+//	The page is tagged PAX_LAYOUT in the header, and HeapPage's record
+//	operations forward to this class, so whole rows are still inserted,
+//	deleted and read back (as a copy) through the HeapPage interface.
+//	Slot numbers are row positions; PaxHeader keeps how many rows fit
+//	and how many are stored.
+//
+//	Data area: PaxHeader, the schema, an occupancy bitmap with one bit
+//	per row, then the minipages, each starting 8-byte aligned.
+class PaxPage : public HeapPage {
+
+protected :
+	struct PaxHeader
+	{
+		short numOfAttrs;	// Number of attributes in the schema.
+		short recLen;		// Length of a whole row.
+		short numOfSlots;	// Number of row positions on this page.
+		short numOfRecords;	// Number of rows in this page (set bits).
+	};
+
+	struct PaxAttr
+	{
+		short type;			// AttrType of the attribute.
+		short offset;		// Offset of the attribute in the row.
+		short length;		// Length of the attribute in bytes.
+		short minipage;		// Offset of the attribute's minipage in the data area.
+	};
+
+	PaxHeader* GetHeader() {
+		return (PaxHeader*)data;
+	}
+
+	PaxAttr* GetAttrs() {
+		return (PaxAttr*)(data + sizeof(PaxHeader));
+	}
+
+	//	Get the occupancy bitmap, which follows the schema.
+	uint* GetBitmap() {
+		return (uint*)(data + sizeof(PaxHeader) + GetHeader()->numOfAttrs * sizeof(PaxAttr));
+	}
+
+	//	Check if the row is empty.
+	bool SlotIsEmpty(int slotNo) {
+		return !TestBit(GetBitmap(), slotNo);
+	}
+
+	//	Get a pointer to the value of an attribute in the given row.
+	char* GetValuePointer(PaxAttr *attr, int slotNo) {
+		return data + attr->minipage + slotNo * attr->length;
+	}
+
+public:
+	//	Inialize the page with given PageID, for rows of the given schema.
+	Status Init(PageID pageNo, const AttrDesc* attrs, int numOfAttrs, int recLen);
+
+	//	Insert a row into the page.
+	Status InsertRecord(const char* recPtr, int recLen, RecordID& rid);
+
+	//	Delete a row from the page.
+	Status DeleteRecord(RecordID rid);
+
+	//	Overwrite a row on the page.
+	Status UpdateRecord(RecordID rid, const char* recPtr, int recLen);
+
+	//	To find the first row on a page.
+	Status FirstRecord(RecordID& firstRid);
+
+	//	To find the next row on a page.
+	Status NextRecord (RecordID curRid, RecordID& nextRid);
+
+	//	To rebuild a COPY of the row with ID rid from the minipages.
+	Status GetRecord(RecordID rid, char* recPtr, int& len);
+
+	//	To retrieve a POINTER to the values of one attribute in all rows.
+	Status GetColumn(int attrNo, const char*& values, int& length);
+
+	//	To return the amount of available space, in whole rows.
+	int    AvailableSpace() { return (GetHeader()->numOfSlots - GetHeader()->numOfRecords) * GetHeader()->recLen; }
+
+	//	Check if there is any row in the page.
+	bool   IsEmpty() { return GetHeader()->numOfRecords == 0; }
+
+	//	Counts the number of rows in the page.
+	int    GetNumOfRecords() { return GetHeader()->numOfRecords; }
+
+	//	To retrieve the occupancy bitmap, one bit per row.
+	const uint* GetOccupancy() { return GetBitmap(); }
+
+	//	Get the number of row positions on the page.
+	int    NumOfSlots() { return GetHeader()->numOfSlots; }
+
+	//	Evaluate a condition on a numeric attribute of every row at once,
+	//	setting bit i of mask (BitmapWords(NumOfSlots()) words) when row i
+	//	exists and matches. As for FixedPage, cond.offset is the offset of
+	//	the field in the row.
+	Status Filter(const Condition& cond, uint* mask);
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _PREDICATE_H
+#define _PREDICATE_H
+
+#include "minirel.h"
+
+//	Maximum number of conditions in a Predicate.
+const int MAX_CONDITIONS = 8;
+
+struct Condition;
+
+//	Compares a field against the constant of a Condition.
+typedef bool (*CompareFunc)(const char *field, const Condition& cond);
+
+//	A comparison of one field, at a fixed offset in the record, against
+//	a constant (or, for opRANGE, an inclusive [low, high] range).
+struct Condition
+{
+	int          offset;	// Offset of the field from the start of the record.
+	int          length;	// Length of the field in bytes.
+	AttrType     type;		// attrInteger, attrReal or attrString.
+	AttrOperator op;		// The comparison to make.
+
+	union Value {
+		int         intVal;
+		double      realVal;
+		const char *strVal;	// Not copied; must outlive the Predicate.
+	} low, high;			// The constant, or the bounds for opRANGE.
+
+	//	The comparison for this type and operator, picked once by Init.
+	CompareFunc  compare;
+
+	//	Set up a condition on an attrInteger or attrReal field.
+	Status Init(int offset, AttrType type, AttrOperator op, double value, double high = 0);
+
+	//	Set up a condition on a fixed-length attrString field.
+	Status Init(int offset, int length, AttrType type, AttrOperator op,
+	            const char *value, const char *high = NULL);
+
+	//	Check if the field of the record satisfies the condition.
+	bool Matches(const char *recPtr, int recLen) const {
+		return offset + length <= recLen && compare(recPtr + offset, *this);
+	}
+};
+
+
+//	A set of conditions combined with lopAND, lopOR or lopNOT, evaluated
+//	directly against record bytes in a page. lopNOT is satisfied when not
+//	all of the conditions hold (with one condition, when it fails).
+class Predicate
+{
+
+private :
+
+	Condition conds[MAX_CONDITIONS];
+	int numOfConds;
+	LogicalOperator lop;
+
+public :
+
+	Predicate(LogicalOperator lop = lopAND);
+	~Predicate();
+
+	//	Add a condition on an attrInteger or attrReal field.
+	Status AddCondition(int offset, AttrType type, AttrOperator op, double value, double high = 0);
+
+	//	Add a condition on a fixed-length attrString field.
+	Status AddCondition(int offset, int length, AttrType type, AttrOperator op,
+	                    const char *value, const char *high = NULL);
+
+	//	Check if the record satisfies the predicate.
+	bool Matches(const char *recPtr, int recLen) const;
+};
+
+#endif
@@ -0,0 +1,331 @@
+#include <string.h>
+#include <memory.h>
+
+#include "filter.h"
+#include "bitops.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FILTER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//	SSE2 is part of the compiler's baseline on x86-64; AVX2 is checked at run time.
+#if defined(FILTER_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FILTER_SSE2
+#endif
+
+#if defined(FILTER_X86) && (defined(__GNUC__) || defined(_MSC_VER))
+#define FILTER_AVX2
+#endif
+
+//	GCC only emits AVX2 instructions in functions marked for it.
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+using namespace std;
+
+//	Find out once which instruction sets the kernels may use.
+static SimdLevel DetectSimdLevel()
+{
+	SimdLevel level = SIMD_NONE;
+#ifdef FILTER_SSE2
+	level = SIMD_SSE2;
+#endif
+#ifdef FILTER_AVX2
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) level = SIMD_AVX2;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool osSaves = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;  // OSXSAVE and AVX
+	if (osSaves && (_xgetbv(0) & 6) == 6) {                                    // OS saves the ymm registers
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5)) level = SIMD_AVX2;
+	}
+#endif
+#endif
+	return level;
+}
+
+static SimdLevel cpuLevel = DetectSimdLevel();     // what the CPU can run
+static SimdLevel simdLevel = cpuLevel;              // what FilterColumn uses
+
+
+//------------------------------------------------------------------
+// Scalar kernel, also used for the values left over by the others.
+//------------------------------------------------------------------
+
+template <class T, AttrOperator OP>
+static bool Matches(T value, T low, T high)
+{
+	switch (OP) {
+	case aopEQ:   return value == low;
+	case aopNE:   return value != low;
+	case aopLT:   return value < low;
+	case aopGT:   return value > low;
+	case aopLE:   return value <= low;
+	case aopGE:   return value >= low;
+	case opRANGE: return low <= value && value <= high;
+	default:      return false;
+	}
+}
+
+template <class T, AttrOperator OP>
+static void FilterScalar(const char *base, int stride, int from, int count, T low, T high, uint *mask)
+{
+	for (int i = from; i < count; i++) {
+		T value;
+		memcpy(&value, base + i * stride, sizeof(T));   // values need not be aligned
+		if (Matches<T, OP>(value, low, high)) {
+			mask[i / BITS_PER_WORD] |= 1u << (i % BITS_PER_WORD);
+		}
+	}
+}
+
+
+#ifdef FILTER_SSE2
+//------------------------------------------------------------------
+// SSE2 kernels, for values stored back to back. Each returns the
+// number of values it handled, a whole number of mask words.
+//------------------------------------------------------------------
+
+template <AttrOperator OP>
+static inline __m128i CompareSSE2(__m128i value, __m128i low, __m128i high)
+{
+	__m128i ones = _mm_set1_epi32(-1);
+	switch (OP) {
+	case aopEQ:   return _mm_cmpeq_epi32(value, low);
+	case aopNE:   return _mm_xor_si128(_mm_cmpeq_epi32(value, low), ones);
+	case aopLT:   return _mm_cmplt_epi32(value, low);
+	case aopGT:   return _mm_cmpgt_epi32(value, low);
+	case aopLE:   return _mm_xor_si128(_mm_cmpgt_epi32(value, low), ones);
+	case aopGE:   return _mm_xor_si128(_mm_cmplt_epi32(value, low), ones);
+	case opRANGE: return _mm_xor_si128(_mm_or_si128(_mm_cmplt_epi32(value, low),
+	                                                _mm_cmpgt_epi32(value, high)), ones);
+	default:      return _mm_setzero_si128();
+	}
+}
+
+template <AttrOperator OP>
+static inline __m128d CompareSSE2(__m128d value, __m128d low, __m128d high)
+{
+	switch (OP) {
+	case aopEQ:   return _mm_cmpeq_pd(value, low);
+	case aopNE:   return _mm_cmpneq_pd(value, low);
+	case aopLT:   return _mm_cmplt_pd(value, low);
+	case aopGT:   return _mm_cmpgt_pd(value, low);
+	case aopLE:   return _mm_cmple_pd(value, low);
+	case aopGE:   return _mm_cmpge_pd(value, low);
+	case opRANGE: return _mm_and_pd(_mm_cmpge_pd(value, low), _mm_cmple_pd(value, high));
+	default:      return _mm_setzero_pd();
+	}
+}
+
+template <AttrOperator OP>
+static int FilterSSE2(const char *base, int count, int low, int high, uint *mask)
+{
+	__m128i lowVec = _mm_set1_epi32(low);
+	__m128i highVec = _mm_set1_epi32(high);
+	int words = count / BITS_PER_WORD;
+	for (int word = 0; word < words; word++) {
+		const int *values = (const int *)base + word * BITS_PER_WORD;
+		uint bits = 0;
+		for (int i = 0; i < BITS_PER_WORD; i += 4) {
+			__m128i value = _mm_loadu_si128((const __m128i *)(values + i));
+			__m128i result = CompareSSE2<OP>(value, lowVec, highVec);
+			bits |= (uint)_mm_movemask_ps(_mm_castsi128_ps(result)) << i;
+		}
+		mask[word] = bits;
+	}
+	return words * BITS_PER_WORD;
+}
+
+template <AttrOperator OP>
+static int FilterSSE2(const char *base, int count, double low, double high, uint *mask)
+{
+	__m128d lowVec = _mm_set1_pd(low);
+	__m128d highVec = _mm_set1_pd(high);
+	int words = count / BITS_PER_WORD;
+	for (int word = 0; word < words; word++) {
+		const double *values = (const double *)base + word * BITS_PER_WORD;
+		uint bits = 0;
+		for (int i = 0; i < BITS_PER_WORD; i += 2) {
+			__m128d value = _mm_loadu_pd(values + i);
+			bits |= (uint)_mm_movemask_pd(CompareSSE2<OP>(value, lowVec, highVec)) << i;
+		}
+		mask[word] = bits;
+	}
+	return words * BITS_PER_WORD;
+}
+#endif
+
+
+#ifdef FILTER_AVX2
+//------------------------------------------------------------------
+// AVX2 kernels. Values stored back to back are loaded directly, and
+// strided ones (a field of fixed-length records) are gathered. The
+// gathers take an explicit zero source and an all-ones mask, so no
+// lane is ever left uninitialized.
+//------------------------------------------------------------------
+
+template <AttrOperator OP>
+TARGET_AVX2 static inline __m256i CompareAVX2(__m256i value, __m256i low, __m256i high)
+{
+	__m256i ones = _mm256_set1_epi32(-1);
+	switch (OP) {
+	case aopEQ:   return _mm256_cmpeq_epi32(value, low);
+	case aopNE:   return _mm256_xor_si256(_mm256_cmpeq_epi32(value, low), ones);
+	case aopLT:   return _mm256_cmpgt_epi32(low, value);
+	case aopGT:   return _mm256_cmpgt_epi32(value, low);
+	case aopLE:   return _mm256_xor_si256(_mm256_cmpgt_epi32(value, low), ones);
+	case aopGE:   return _mm256_xor_si256(_mm256_cmpgt_epi32(low, value), ones);
+	case opRANGE: return _mm256_xor_si256(_mm256_or_si256(_mm256_cmpgt_epi32(low, value),
+	                                                      _mm256_cmpgt_epi32(value, high)), ones);
+	default:      return _mm256_setzero_si256();
+	}
+}
+
+template <AttrOperator OP>
+TARGET_AVX2 static inline __m256d CompareAVX2(__m256d value, __m256d low, __m256d high)
+{
+	switch (OP) {
+	case aopEQ:   return _mm256_cmp_pd(value, low, _CMP_EQ_OQ);
+	case aopNE:   return _mm256_cmp_pd(value, low, _CMP_NEQ_UQ);
+	case aopLT:   return _mm256_cmp_pd(value, low, _CMP_LT_OQ);
+	case aopGT:   return _mm256_cmp_pd(value, low, _CMP_GT_OQ);
+	case aopLE:   return _mm256_cmp_pd(value, low, _CMP_LE_OQ);
+	case aopGE:   return _mm256_cmp_pd(value, low, _CMP_GE_OQ);
+	case opRANGE: return _mm256_and_pd(_mm256_cmp_pd(value, low, _CMP_GE_OQ),
+	                                   _mm256_cmp_pd(value, high, _CMP_LE_OQ));
+	default:      return _mm256_setzero_pd();
+	}
+}
+
+template <AttrOperator OP>
+TARGET_AVX2 static int FilterAVX2(const char *base, int stride, int count, int low, int high, uint *mask)
+{
+	__m256i lowVec = _mm256_set1_epi32(low);
+	__m256i highVec = _mm256_set1_epi32(high);
+	__m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	__m256i zero = _mm256_setzero_si256();
+	__m256i all = _mm256_set1_epi32(-1);
+	int words = count / BITS_PER_WORD;
+	for (int word = 0; word < words; word++) {
+		const char *values = base + word * BITS_PER_WORD * stride;
+		uint bits = 0;
+		for (int i = 0; i < BITS_PER_WORD; i += 8) {
+			__m256i value = (stride == (int)sizeof(int))
+				? _mm256_loadu_si256((const __m256i *)(values + i * stride))
+				: _mm256_mask_i32gather_epi32(zero, (const int *)(values + i * stride), offsets, all, 1);
+			__m256i result = CompareAVX2<OP>(value, lowVec, highVec);
+			bits |= (uint)_mm256_movemask_ps(_mm256_castsi256_ps(result)) << i;
+		}
+		mask[word] = bits;
+	}
+	return words * BITS_PER_WORD;
+}
+
+template <AttrOperator OP>
+TARGET_AVX2 static int FilterAVX2(const char *base, int stride, int count, double low, double high, uint *mask)
+{
+	__m256d lowVec = _mm256_set1_pd(low);
+	__m256d highVec = _mm256_set1_pd(high);
+	__m128i offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(stride));
+	__m256d zero = _mm256_setzero_pd();
+	__m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+	int words = count / BITS_PER_WORD;
+	for (int word = 0; word < words; word++) {
+		const char *values = base + word * BITS_PER_WORD * stride;
+		uint bits = 0;
+		for (int i = 0; i < BITS_PER_WORD; i += 4) {
+			__m256d value = (stride == (int)sizeof(double))
+				? _mm256_loadu_pd((const double *)(values + i * stride))
+				: _mm256_mask_i32gather_pd(zero, (const double *)(values + i * stride), offsets, all, 1);
+			bits |= (uint)_mm256_movemask_pd(CompareAVX2<OP>(value, lowVec, highVec)) << i;
+		}
+		mask[word] = bits;
+	}
+	return words * BITS_PER_WORD;
+}
+#endif
+
+
+//	Run the best kernel available for as many whole mask words as it
+//	takes, then finish the remaining values in scalar code.
+template <class T, AttrOperator OP>
+static void Filter(const char *base, int stride, int count, T low, T high, uint *mask)
+{
+	int done = 0;
+#ifdef FILTER_AVX2
+	if (simdLevel == SIMD_AVX2) done = FilterAVX2<OP>(base, stride, count, low, high, mask);
+#endif
+#ifdef FILTER_SSE2
+	if (done == 0 && simdLevel >= SIMD_SSE2 && stride == (int)sizeof(T)) done = FilterSSE2<OP>(base, count, low, high, mask);
+#endif
+	FilterScalar<T, OP>(base, stride, done, count, low, high, mask);
+}
+
+template <class T>
+static Status Filter(const char *base, int stride, int count, AttrOperator op, T low, T high, uint *mask)
+{
+	switch (op) {
+	case aopEQ:   Filter<T, aopEQ>(base, stride, count, low, high, mask);   break;
+	case aopNE:   Filter<T, aopNE>(base, stride, count, low, high, mask);   break;
+	case aopLT:   Filter<T, aopLT>(base, stride, count, low, high, mask);   break;
+	case aopGT:   Filter<T, aopGT>(base, stride, count, low, high, mask);   break;
+	case aopLE:   Filter<T, aopLE>(base, stride, count, low, high, mask);   break;
+	case aopGE:   Filter<T, aopGE>(base, stride, count, low, high, mask);   break;
+	case opRANGE: Filter<T, opRANGE>(base, stride, count, low, high, mask); break;
+	default:      return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FilterColumn
+//
+// Input    : Address of the first value, distance in bytes between
+//            values, number of values, and the condition to test.
+// Output   : A bitmask with a bit set for every matching value.
+// Purpose  : Evaluate a condition on a numeric field over many records
+//            at once.
+// Return   : OK if successful, FAIL if the type or operator is not
+//            supported.
+//------------------------------------------------------------------
+
+Status FilterColumn(const char *base, int stride, int count, const Condition& cond, uint *mask)
+{
+	memset(mask, 0, BitmapWords(count) * sizeof(uint));   // kernels only set the bits that match
+
+	if (cond.type == attrInteger)
+		return Filter<int>(base, stride, count, cond.op, cond.low.intVal, cond.high.intVal, mask);
+	if (cond.type == attrReal)
+		return Filter<double>(base, stride, count, cond.op, cond.low.realVal, cond.high.realVal, mask);
+	return FAIL;
+}
+
+
+//------------------------------------------------------------------
+// SetFilterSimdLevel
+//
+// Input    : The highest level of kernels FilterColumn may use.
+// Output   : None.
+// Purpose  : Limit FilterColumn to slower kernels, without ever
+//            going past what the CPU supports.
+// Return   : The level in use before.
+//------------------------------------------------------------------
+
+SimdLevel SetFilterSimdLevel(SimdLevel level)
+{
+	SimdLevel previous = simdLevel;
+	simdLevel = (level < cpuLevel) ? level : cpuLevel;
+	return previous;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "fixedpage.h"
+#include "filter.h"
+
+using namespace std;
+
+//------------------------------------------------------------------
+// FixedPage::Init
+//
+// Input     : Page ID, length of the records to be stored.
+// Output    : None.
+// Purpose   : Inialize the page with given PageID. The data area is
+//             split into as many record positions as fit together with
+//             their bits in the occupancy bitmap.
+// Return    : OK if successful, FAIL if not even one record of the
+//             given length fits.
+//------------------------------------------------------------------
+
+Status FixedPage::Init(PageID pageNo, int length)
+{
+	int fixed = sizeof(FixedHeader);
+	if (length <= 0 || fixed + (int)sizeof(uint) + length > HEAPPAGE_DATA_SIZE) return FAIL;
+
+	// each record costs length bytes plus one bit; round down for the bitmap words
+	int slots = (HEAPPAGE_DATA_SIZE - fixed) * 8 / (length * 8 + 1);
+	while (fixed + BitmapWords(slots) * (int)sizeof(uint) + slots * length > HEAPPAGE_DATA_SIZE) {
+		slots--;
+	}
+
+	HeapPage::Init(pageNo);
+	type = FIXED_LAYOUT;
+
+	FixedHeader *header = GetHeader();
+	header->recLen = length;
+	header->records = fixed + BitmapWords(slots) * sizeof(uint);
+
+	header->numOfSlots = slots;                  // every record position is a slot
+	header->numOfRecords = 0;
+	freePtr = header->records + slots * length;  // the data area is laid out up to here
+	memset(GetBitmap(), 0, BitmapWords(slots) * sizeof(uint));  // all positions start empty
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::InsertRecord
+//
+// Input     : Pointer to the record and the record's length.
+// Output    : Record ID of the record inserted.
+// Purpose   : Insert a record into the first empty position.
+// Return    : OK if everything went OK, DONE if the page is full,
+//             FAIL if the record is not of this page's length.
+//------------------------------------------------------------------
+
+Status FixedPage::InsertRecord(const char *recPtr, int length, RecordID& rid)
+{
+	if (length != GetHeader()->recLen) return FAIL;
+
+	int slotNo = FindClearBit(GetBitmap(), GetHeader()->numOfSlots);  // first empty position
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	SetBit(GetBitmap(), slotNo);
+	memcpy(GetRecordPointer(slotNo), recPtr, length);
+	GetHeader()->numOfRecords++;
+
+	rid.pageNo = PageNo();
+	rid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::DeleteRecord
+//
+// Input    : Record ID.
+// Output   : None.
+// Purpose  : Delete a record from the page.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status FixedPage::DeleteRecord(RecordID rid)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	ClearBit(GetBitmap(), rid.slotNo);
+	GetHeader()->numOfRecords--;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::UpdateRecord
+//
+// Input    : Record ID, pointer to the new record and its length.
+// Output   : None.
+// Purpose  : Overwrite a record on the page.
+// Return   : OK if successful, FAIL if there is no such record or the
+//            new record is not of this page's length.
+//------------------------------------------------------------------
+
+Status FixedPage::UpdateRecord(RecordID rid, const char *recPtr, int length)
+{
+	if (length != GetHeader()->recLen) return FAIL;
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	memmove(GetRecordPointer(rid.slotNo), recPtr, length);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::FirstRecord
+//
+// Input    : None.
+// Output   : Record id of the first record on a page.
+// Purpose  : To find the first record on a page.
+// Return   : OK if successful, DONE otherwise.
+//------------------------------------------------------------------
+
+Status FixedPage::FirstRecord(RecordID& rid)
+{
+	int slotNo = FindSetBit(GetBitmap(), 0, GetHeader()->numOfSlots);
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	rid.pageNo = PageNo();
+	rid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::NextRecord
+//
+// Input    : ID of the current record.
+// Output   : ID of the next record.
+// Purpose  : To find the next record on a page.
+// Return   : Return DONE if no more records exist on the page;
+//            otherwise OK.
+//------------------------------------------------------------------
+
+Status FixedPage::NextRecord(RecordID curRid, RecordID& nextRid)
+{
+	int slotNo = FindSetBit(GetBitmap(), curRid.slotNo + 1, GetHeader()->numOfSlots);
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	nextRid.pageNo = PageNo();
+	nextRid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::GetRecord
+//
+// Input    : rid - Record ID. len - the length of allocated memory.
+// Output   : Records length and a copy of the record itself.
+// Purpose  : To retrieve a COPY of a record with ID rid from a page.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status FixedPage::GetRecord(RecordID rid, char *recPtr, int& len)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	memcpy(recPtr, GetRecordPointer(rid.slotNo), GetHeader()->recLen);
+	len = GetHeader()->recLen;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::ReturnRecord
+//
+// Input    : Record ID.
+// Output   : Pointer to the record, record's length.
+// Purpose  : To retrieve a POINTER to the record.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status FixedPage::ReturnRecord(RecordID rid, char*& recPtr, int& len)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	recPtr = GetRecordPointer(rid.slotNo);
+	len = GetHeader()->recLen;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FixedPage::Filter
+//
+// Input    : A condition on an attrInteger or attrReal field.
+// Output   : A bitmask of the records that satisfy it.
+// Purpose  : Evaluate a condition on every record of the page at once,
+//            with the vectorized kernels of FilterColumn.
+// Return   : OK if successful, FAIL if the field does not lie within
+//            the records or the condition is not supported.
+//------------------------------------------------------------------
+
+Status FixedPage::Filter(const Condition& cond, uint *mask)
+{
+	int recLen = GetHeader()->recLen;
+	int size = (cond.type == attrReal) ? sizeof(double) : sizeof(int);
+	if (cond.offset < 0 || cond.offset + size > recLen) return FAIL;
+
+	Status status = FilterColumn(GetRecordPointer(0) + cond.offset, recLen, GetHeader()->numOfSlots, cond, mask);
+	if (status != OK) return status;
+
+	AndBits(mask, GetBitmap(), GetHeader()->numOfSlots);       // drop matches in empty positions
+	return OK;
+}
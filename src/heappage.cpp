@@ -3,6 +3,9 @@
 #include <memory.h>
 
 #include "heappage.h"
+#include "paxpage.h"
+#include "fixedpage.h"
+#include "predicate.h"
 #include "heapfile.h"
 #include "db.h"
 
@@ -24,6 +27,9 @@ void HeapPage::Init(PageID pageNo)
 	pid = pageNo;               
 	freePtr = 0;                // start pointer at beginning of data array
 	freeSpace = HEAPPAGE_DATA_SIZE;  // free space starts as full data array
+	freeSlot = INVALID_SLOT;         // no empty slots to reuse yet
+	numOfRecords = 0;                // no records yet
+	type = ROW_LAYOUT;               // slotted layout, unless PaxPage or FixedPage::Init changes it
 }
 
 
@@ -39,32 +45,34 @@ void HeapPage::Init(PageID pageNo)
 
 Status HeapPage::InsertRecord(const char *recPtr, int length, RecordID& rid)
 {
-	if(freeSpace < length) return DONE;			 // if there's not enough free space in array to fit record
+	if(type == PAX_LAYOUT) return ((PaxPage*)this)->InsertRecord(recPtr, length, rid);
+	if(type == FIXED_LAYOUT) return ((FixedPage*)this)->InsertRecord(recPtr, length, rid);
 
-	bool emptySlot = false;                      // boolean to store whether there's an empty slot available
-	Slot *slotPointer = GetFirstSlotPointer();   // start looking in first slot
-	int currSlot = 0;                            // counter for slots 
-	while(currSlot < numOfSlots) {               // loop through all slots in numSlots
-		if(SlotIsEmpty(slotPointer)) {
-			// empty slot found, insert here
-			emptySlot = true;
-			break;
-		}
-		slotPointer--; //current pointer not to empty so try next one
-		currSlot++;
-    }
+	if(freeSpace < length) return DONE;			 // if there's not enough free space in array to fit record
 
-	if(!emptySlot) {                              //no empty slot found
-		if(freeSpace < length + sizeof(Slot)) return DONE; // if there's not enough space for slot + record, quit
+	// if the space is there but fragmented by deletes, Compact squeezes it out
+	Slot *slotPointer;                           // slot the record will be stored in
+	int currSlot = freeSlot;                     // take the head of the free-slot list, if any
+	if(currSlot != INVALID_SLOT) {
+		slotPointer = GetFirstSlotPointer() - currSlot;  // reuse the empty slot
+		freeSlot = slotPointer->offset;                  // unlink it from the free-slot list
+		if(ContiguousFreeSpace() < length) Compact();
+	}
+	else {                                        //no empty slot available
+		if(freeSpace < length + (int)sizeof(Slot)) return DONE; // if there's not enough space for slot + record, quit
+		if(ContiguousFreeSpace() < length + (int)sizeof(Slot)) Compact(); // the new slot may overlap records too
+		currSlot = numOfSlots;                    // new slot goes after the last one
+		slotPointer = GetFirstSlotPointer() - currSlot;
 		numOfSlots++;                             // increment number of slots for new slot
 		freeSpace -= sizeof(Slot);                // adjust free space for new slot space
-	} 
+	}
 
 	FillSlot(slotPointer, freePtr, length);       // call FillSlot to create new slot at slotPointer's location
 
 	memcpy(&(data[freePtr]), recPtr, length);     // move new record data to free pointer location    
 	freeSpace -= length;                      // remove record size from freespace
 	freePtr += length;                        // move free pointer forward by record size
+	numOfRecords++;                           // one more record on the page
 
 	rid.pageNo = PageNo();                    // store current page in record ID
 	rid.slotNo = currSlot;                    // store current slot No in record ID
@@ -72,6 +80,69 @@ Status HeapPage::InsertRecord(const char *recPtr, int length, RecordID& rid)
 }
 
 
+//------------------------------------------------------------------
+// HeapPage::InsertRecords
+//
+// Input     : Arrays of pointers to the records and of their lengths,
+//             and the number of records in them.
+// Output    : Record IDs of the records inserted.
+// Purpose   : Insert as many of the given records as fit into the
+//             page, in order. Space is checked and compacted once for
+//             the whole run, and the records are copied back to back.
+// Return    : The number of records inserted; the rest did not fit.
+//------------------------------------------------------------------
+
+int HeapPage::InsertRecords(const char* const* recPtrs, const int* recLens, int numOfRecs, RecordID* rids)
+{
+	if (type != ROW_LAYOUT) {                    // rows go in one at a time, each into its own position
+		int count = 0;
+		while (count < numOfRecs && InsertRecord(recPtrs[count], recLens[count], rids[count]) == OK) count++;
+		return count;
+	}
+
+	// work out how many records fit, walking the free-slot list without unlinking it yet
+	int count = 0;                               // number of records that fit
+	int needed = 0;                              // bytes needed for them and any new slots
+	int currSlot = freeSlot;
+	while (count < numOfRecs) {
+		int cost = recLens[count];
+		if (currSlot == INVALID_SLOT) cost += sizeof(Slot);    // record needs a new slot too
+		if (needed + cost > freeSpace) break;                  // this one does not fit, stop here
+		if (currSlot != INVALID_SLOT) currSlot = (GetFirstSlotPointer() - currSlot)->offset;
+		needed += cost;
+		count++;
+	}
+	if (count == 0) return 0;
+
+	if (ContiguousFreeSpace() < needed) Compact(); // space is there but fragmented by deletes, so squeeze it out
+
+	for (int i = 0; i < count; i++) {
+		Slot *slotPointer;
+		if (freeSlot != INVALID_SLOT) {          // reuse the empty slot at the head of the free-slot list
+			currSlot = freeSlot;
+			slotPointer = GetFirstSlotPointer() - currSlot;
+			freeSlot = slotPointer->offset;
+		}
+		else {                                   // add a new slot after the last one
+			currSlot = numOfSlots;
+			slotPointer = GetFirstSlotPointer() - currSlot;
+			numOfSlots++;
+		}
+
+		FillSlot(slotPointer, freePtr, recLens[i]);
+		memcpy(&(data[freePtr]), recPtrs[i], recLens[i]);
+		freePtr += recLens[i];
+
+		rids[i].pageNo = PageNo();
+		rids[i].slotNo = currSlot;
+	}
+
+	freeSpace -= needed;                          // remove records and new slots from freespace
+	numOfRecords += count;                        // count more records on the page
+	return count;
+}
+
+
 //------------------------------------------------------------------
 // HeapPage::DeleteRecord 
 //
@@ -83,36 +154,123 @@ Status HeapPage::InsertRecord(const char *recPtr, int length, RecordID& rid)
 
 Status HeapPage::DeleteRecord(RecordID rid)
 {
+	if (type == PAX_LAYOUT) return ((PaxPage*)this)->DeleteRecord(rid);
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->DeleteRecord(rid);
+
 	if (rid.slotNo >= numOfSlots) return FAIL;          // if the slotNo is greater than the number of slots, fail
 	Slot* cur = GetFirstSlotPointer() - rid.slotNo;     // make a slot pointer to slot that record is in 
 	if (SlotIsEmpty(cur)) return FAIL;                  // if that slot is actually empty, fail
 
-	//move data that starts after record and ends at free pointer up to the location where the record to 
-	//be deleted starts, to free memory space. 
-	memmove(&(data[cur->offset]), &(data[cur->offset + cur->length]), freePtr-(cur->offset + cur->length));
-
-	Slot* slotPointer = GetFirstSlotPointer();
-	int currSlot = 0;
-	while(currSlot < numOfSlots) {                  // loop through all slots
-		if(slotPointer->offset > cur->offset) {     // if slot is to an offset higher than slot with deletion
-			slotPointer->offset -= cur->length;        // decrease the offset by length of removed record
-		}
-		slotPointer--;                              // move to next slot
-		currSlot++;
+	// the record's bytes are only reclaimed by the next Compact, unless it is the
+	// last record in the data area and freePtr can simply move back over it
+	if (cur->offset + cur->length == freePtr) {
+		freePtr -= cur->length;                     // move free space pointer back by size of record removed
 	}
-
 	freeSpace += cur->length;                       // increase free space by size of record removed
-	freePtr -= cur->length;                         // move free space pointer back by size of record removed
 	SetSlotEmpty(cur);                              // set slot that had record deleted to empty
+	numOfRecords--;                                 // one less record on the page
 	
 	if (rid.slotNo == numOfSlots - 1) {             // if slot was last slot, we can delete the slot as well
 		numOfSlots--;                               // decrease number of slots
 		freeSpace += sizeof(Slot);                  // increase freespace by size of one slot
 	}
+	else {
+		PushFreeSlot(cur, rid.slotNo);              // otherwise keep it on the free-slot list for reuse
+	}
 	return OK;
 }
 
 
+//------------------------------------------------------------------
+// HeapPage::UpdateRecord
+//
+// Input    : Record ID, pointer to the new record and its length.
+// Output   : None.
+// Purpose  : Replace a record on the page, keeping its Record ID. A
+//            record that shrinks or keeps its size is overwritten in
+//            place; one that grows is moved within the page under the
+//            same slot. recPtr may point into this page (e.g. at a
+//            record returned by ReturnRecord); it is copied aside
+//            before the page is compacted.
+// Return   : OK if successful, FAIL if there is no such record, DONE
+//            if the new record does not fit in this page.
+//------------------------------------------------------------------
+
+Status HeapPage::UpdateRecord(RecordID rid, const char *recPtr, int length)
+{
+	if (type == PAX_LAYOUT) return ((PaxPage*)this)->UpdateRecord(rid, recPtr, length);
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->UpdateRecord(rid, recPtr, length);
+
+	if (rid.slotNo >= numOfSlots) return FAIL;          // if the slotNo is greater than the number of slots, fail
+	Slot* cur = GetFirstSlotPointer() - rid.slotNo;     // make a slot pointer to slot that record is in 
+	if (SlotIsEmpty(cur)) return FAIL;                  // if that slot is actually empty, fail
+
+	if (length <= cur->length) {                        // new record fits where the old one is
+		if (cur->offset + cur->length == freePtr) {     // last record in the data area gives its tail back to freePtr
+			freePtr -= cur->length - length;
+		}
+		freeSpace += cur->length - length;              // increase free space by the bytes no longer used
+		memmove(&(data[cur->offset]), recPtr, length);  // memmove, since recPtr may point at the record itself
+		cur->length = length;
+		return OK;
+	}
+
+	if (freeSpace + cur->length < length) return DONE;  // not enough space even without the old record, caller must move it
+
+	char copy[HEAPPAGE_DATA_SIZE];
+	if (recPtr >= data && recPtr < data + HEAPPAGE_DATA_SIZE) {  // the source is on this page and Compact may move it
+		memcpy(copy, recPtr, length);
+		recPtr = copy;
+	}
+
+	// release the old record and store the new one at freePtr under the same slot
+	if (cur->offset + cur->length == freePtr) {         // if it was the last record, the new one simply starts where it did
+		freePtr -= cur->length;
+	}
+	freeSpace += cur->length;                           // increase free space by size of the old record
+	SetSlotEmpty(cur);                                  // so that Compact drops the old record
+	if (ContiguousFreeSpace() < length) Compact();      // space is there but fragmented, so squeeze it out
+
+	FillSlot(cur, freePtr, length);                     // point the slot at the new location
+	memmove(&(data[freePtr]), recPtr, length);          // copy the new record in
+	freeSpace -= length;                                // remove record size from freespace
+	freePtr += length;                                  // move free pointer forward by record size
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::Compact
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Slide all records to the start of the data area, so that
+//            the space freed by deletes becomes contiguous again.
+// Return   : None.
+//------------------------------------------------------------------
+
+void HeapPage::Compact()
+{
+	char compacted[HEAPPAGE_DATA_SIZE];           // records are packed here, then copied back in one go
+	int offset = 0;                               // where the next record goes
+
+	Slot *slotPointer = GetFirstSlotPointer();
+	int currSlot = 0;
+	while(currSlot < numOfSlots) {                // loop through all slots
+		if (!SlotIsEmpty(slotPointer)) {          // move the record and point its slot at the new place
+			memcpy(&(compacted[offset]), &(data[slotPointer->offset]), slotPointer->length);
+			slotPointer->offset = offset;
+			offset += slotPointer->length;
+		}
+		slotPointer--;
+		currSlot++;
+	}
+
+	memcpy(data, compacted, offset);              // copy packed records back to the data area
+	freePtr = offset;                             // free space now starts right after them
+}
+
+
 //------------------------------------------------------------------
 // HeapPage::FirstRecord
 //
@@ -124,10 +282,18 @@ Status HeapPage::DeleteRecord(RecordID rid)
 
 Status HeapPage::FirstRecord(RecordID& rid)
 {
+	if (type == PAX_LAYOUT) return ((PaxPage*)this)->FirstRecord(rid);
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->FirstRecord(rid);
+
 	if (IsEmpty()) return DONE;           // if empty, unsucessful
 	Slot* f = GetFirstSlotPointer();      // set pointer to first slot
+	int currSlot = 0;
+	while (SlotIsEmpty(f)) {              // skip slots emptied by deletes; IsEmpty guarantees a record follows
+		f--;
+		currSlot++;
+	}
 	rid.pageNo = PageNo();                // store pageNo in rid
-	rid.slotNo = 0;                       // store slotNo in rid
+	rid.slotNo = currSlot;                // store slotNo in rid
 	return OK;
 }
 
@@ -144,6 +310,9 @@ Status HeapPage::FirstRecord(RecordID& rid)
 
 Status HeapPage::NextRecord(RecordID curRid, RecordID& nextRid)
 {
+	if (type == PAX_LAYOUT) return ((PaxPage*)this)->NextRecord(curRid, nextRid);
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->NextRecord(curRid, nextRid);
+
 	Slot * slotPointer = GetFirstSlotPointer() - curRid.slotNo;  // set slot pointer to slot of given record
 	int currSlot = curRid.slotNo;                                // store the slot number of given record
 	while(currSlot < numOfSlots) {                               // loop through slots
@@ -170,6 +339,9 @@ Status HeapPage::NextRecord(RecordID curRid, RecordID& nextRid)
 
 Status HeapPage::GetRecord(RecordID rid, char *recPtr, int& len)
 {
+	if (type == PAX_LAYOUT) return ((PaxPage*)this)->GetRecord(rid, recPtr, len);
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->GetRecord(rid, recPtr, len);
+
 	int slotno = rid.slotNo;                           //store slotNo of given rid
     if (slotno >= numOfSlots) return FAIL;             //if slotNo is too high, fail
 	Slot* f = GetFirstSlotPointer() - slotno;          //set pointer to that slot
@@ -191,6 +363,9 @@ Status HeapPage::GetRecord(RecordID rid, char *recPtr, int& len)
 
 Status HeapPage::ReturnRecord(RecordID rid, char*& recPtr, int& len)
 {
+	if (type == PAX_LAYOUT) return FAIL;          // rows are split across minipages, use GetRecord
+	if (type == FIXED_LAYOUT) return ((FixedPage*)this)->ReturnRecord(rid, recPtr, len);
+
 	int slotno = rid.slotNo;                      // store slotNo of rid
 	if (slotno >= numOfSlots) return FAIL;        // if slotNo too high, fail
 	Slot* f = GetFirstSlotPointer() - slotno;     // set pointer to slot of rid
@@ -212,6 +387,9 @@ Status HeapPage::ReturnRecord(RecordID rid, char*& recPtr, int& len)
 
 int HeapPage::AvailableSpace()
 {
+	if(type == PAX_LAYOUT) return ((PaxPage*)this)->AvailableSpace();
+	if(type == FIXED_LAYOUT) return ((FixedPage*)this)->AvailableSpace();
+
 	return freeSpace;    // return freespace variable
 }
 
@@ -227,7 +405,10 @@ int HeapPage::AvailableSpace()
 
 bool HeapPage::IsEmpty()
 {
-	return GetNumOfRecords() == 0;   // return if number of records variable is 0
+	if(type == PAX_LAYOUT) return ((PaxPage*)this)->IsEmpty();
+	if(type == FIXED_LAYOUT) return ((FixedPage*)this)->IsEmpty();
+
+	return numOfRecords == 0;   // return if number of records variable is 0
 }
 
 //------------------------------------------------------------------
@@ -241,19 +422,10 @@ bool HeapPage::IsEmpty()
 
 int HeapPage::GetNumOfRecords()
 {
-	int count = 0;        // initialize count to 0
-
-	Slot *slotPointer = GetFirstSlotPointer();  //get pointer to first slot
-	int currSlot = 0;                           //start slot count at 0
-	while(currSlot < numOfSlots) {              //loop through all slots
-		if (!SlotIsEmpty(slotPointer)) {    //if the current slot is not empty
-			count++;                        //increment count
-		}
-		slotPointer--;                      //move slot pointer and counter
-		currSlot++;
-	}
+	if(type == PAX_LAYOUT) return ((PaxPage*)this)->GetNumOfRecords();
+	if(type == FIXED_LAYOUT) return ((FixedPage*)this)->GetNumOfRecords();
 
-	return count;   //return count variable
+	return numOfRecords;   // kept up to date by InsertRecord and DeleteRecord
 }
 
 
@@ -320,4 +492,127 @@ PageID HeapPage::GetPrevPage()
 PageID HeapPage::PageNo() 
 {
 	return pid;     // return pid variable
-}   
\ No newline at end of file
+}   
+
+
+//------------------------------------------------------------------
+// HeapPageIterator::HeapPageIterator
+// 
+// Input    : The HeapPage to iterate over, which must stay pinned, and
+//            optionally a predicate the records must satisfy.
+// Output   : None.
+// Purpose  : Start an iteration before the first record of the page.
+// Return   : None.
+//------------------------------------------------------------------
+HeapPageIterator::HeapPageIterator(HeapPage *p, const Predicate *predicate)
+{
+	page = p;         // page being walked
+	pred = predicate; // records failing it are skipped, NULL for none
+	currSlot = 0;     // next slot to look at
+	status = OK;      // DONE once the records run out, FAIL if the page cannot be walked
+}
+
+HeapPageIterator::~HeapPageIterator()
+{
+}
+
+//------------------------------------------------------------------
+// HeapPageIterator::operator()
+// 
+// Input    : None.
+// Output   : Record ID and length of the next record.
+// Purpose  : Advance to the next (matching) record of the page.
+// Return   : A pointer to the record in the page, or NULL if there
+//            are no more records (GetStatus is DONE) or the page is
+//            of PAX_LAYOUT (GetStatus is FAIL).
+//------------------------------------------------------------------
+const char *HeapPageIterator::operator() (RecordID& rid, int& len)
+{
+	if (page->type == PAX_LAYOUT) {               // no contiguous rows to point at
+		status = FAIL;
+		return NULL;
+	}
+	if (page->type == FIXED_LAYOUT) {             // walk the set bits of the occupancy bitmap
+		FixedPage *fixed = (FixedPage*)page;
+		RecordID cur;
+		char *recPtr;
+		int recLen;
+		cur.pageNo = page->PageNo();
+		while ((cur.slotNo = FindSetBit(fixed->GetOccupancy(), currSlot, fixed->NumOfSlots())) < fixed->NumOfSlots()) {
+			currSlot = cur.slotNo + 1;
+			fixed->ReturnRecord(cur, recPtr, recLen);
+			if (pred == NULL || pred->Matches(recPtr, recLen)) {
+				rid = cur;
+				len = recLen;
+				return recPtr;
+			}
+		}
+		currSlot = fixed->NumOfSlots();
+		status = DONE;
+		return NULL;
+	}
+
+	HeapPage::Slot *slotPointer = page->GetFirstSlotPointer() - currSlot;
+	while (currSlot < page->numOfSlots) {        // loop through the remaining slots
+		if (!page->SlotIsEmpty(slotPointer) &&   // found a matching record, step past it and return it
+			(pred == NULL || pred->Matches(&(page->data[slotPointer->offset]), slotPointer->length))) {
+			rid.pageNo = page->PageNo();
+			rid.slotNo = currSlot++;
+			len = slotPointer->length;
+			return &(page->data[slotPointer->offset]);
+		}
+		slotPointer--;
+		currSlot++;
+	}
+	status = DONE;
+	return NULL;
+}
+
+//------------------------------------------------------------------
+// HeapPageIterator::FillBatch
+// 
+// Input    : A batch, which may already hold records of other pages.
+// Output   : The batch with the next records of the page appended.
+// Purpose  : Advance over as many (matching) records as fit in the
+//            batch.
+// Return   : OK if the batch filled up, DONE if there are no more
+//            records on the page, FAIL if the page is of PAX_LAYOUT.
+//------------------------------------------------------------------
+Status HeapPageIterator::FillBatch(RecordBatch& batch)
+{
+	if (page->type != ROW_LAYOUT) {               // walk record by record, as operator() does for these layouts
+		RecordID rid;
+		const char *recPtr;
+		int len;
+		while (!batch.IsFull()) {
+			if ((recPtr = (*this)(rid, len)) == NULL) return status;
+			batch.rids[batch.numOfRecords] = rid;
+			batch.recPtrs[batch.numOfRecords] = recPtr;
+			batch.recLens[batch.numOfRecords] = len;
+			batch.numOfRecords++;
+		}
+		return OK;
+	}
+
+	HeapPage::Slot *slotPointer = page->GetFirstSlotPointer() - currSlot;
+	int count = batch.numOfRecords;
+	while (currSlot < page->numOfSlots) {        // loop through the remaining slots
+		if (count == RECORD_BATCH_SIZE) {        // no room left, the caller comes back for the rest
+			batch.numOfRecords = count;
+			return OK;
+		}
+		if (!page->SlotIsEmpty(slotPointer) &&   // append the matching record to the batch
+			(pred == NULL || pred->Matches(&(page->data[slotPointer->offset]), slotPointer->length))) {
+			batch.rids[count].pageNo = page->PageNo();
+			batch.rids[count].slotNo = currSlot;
+			batch.recPtrs[count] = &(page->data[slotPointer->offset]);
+			batch.recLens[count] = slotPointer->length;
+			count++;
+		}
+		slotPointer--;
+		currSlot++;
+	}
+	batch.numOfRecords = count;
+	status = DONE;
+	return DONE;
+}
@@ -8,12 +8,21 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stddef.h>
+#include <limits.h>
+#include <math.h>
 
 #include "db.h"
 #include "heapfile.h"
 #include "scan.h"
 #include "heaptest.h"
 #include "bufmgr.h"
+#include "heappage.h"
+#include "fixedpage.h"
+#include "paxpage.h"
+#include "bitops.h"
+#include "predicate.h"
+#include "filter.h"
 
 using namespace std;
 
@@ -562,7 +571,954 @@ bool HeapDriver::Test5()
 }
 
 
+//*****************************************************
+//***	Test 6: Page operations on a local page		***
 bool HeapDriver::Test6()
 {
+    cout << "\n  Test 6: Page operations on a local page\n";
+    bool ok = true;
+
+    ok = PageTestFreeSlots() && ok;
+    ok = PageTestCompaction() && ok;
+    ok = PageTestRecordCount() && ok;
+    ok = PageTestUpdate() && ok;
+    ok = PageTestInsertBatch() && ok;
+    ok = PageTestFixed() && ok;
+    ok = PageTestPredicate() && ok;
+    ok = PageTestFilterKernels() && ok;
+    ok = PageTestPax() && ok;
+    ok = PageTestIterator() && ok;
+    ok = PageTestBatch() && ok;
+    ok = PageTestPushdown() && ok;
+
+    if ( ok )
+        cout << "  Test 6 completed successfully.\n";
+    return ok;
+}
+
+
+//	Report a failed page check.
+static bool PageCheck( bool condition, const char* what )
+{
+    if ( !condition )
+        cerr << "*** " << what << endl;
+    return condition;
+}
+
+//	Fill in a record with the given number.
+static void MakeRec( Rec& rec, int i )
+{
+    memset( &rec, 0, sizeof rec );
+    rec.ival = i;
+    rec.fval = i*2.5;
+    sprintf( rec.name, "record %i", i );
+}
+
+
+//	Check that the record in the given slot is still the pattern it was
+//	inserted with by FillPage.
+static bool PageRecordIntact( HeapPage* page, PageID pageNo, int slotNo, int length )
+{
+    char record[MAX_SPACE], expected[MAX_SPACE];
+    RecordID rid;
+    int len;
+    rid.pageNo = pageNo;
+    rid.slotNo = slotNo;
+    memset( expected, 'a' + slotNo % 26, length );
+    return page->GetRecord( rid, record, len ) == OK && len == length
+           && memcmp( record, expected, length ) == 0;
+}
+
+//	Insert records of the given length until the page is full, each one
+//	filled with a letter picked by its slot number. Returns the count.
+static int FillPage( HeapPage* page, int length )
+{
+    char record[MAX_SPACE];
+    RecordID rid;
+    int count = 0;
+    for ( ;; )
+	{
+        memset( record, 'a' + count % 26, length );
+        if ( page->InsertRecord( record, length, rid ) != OK )
+            break;
+        count++;
+	}
+    return count;
+}
+
+
+//	Deleted slots are reused last in, first out, and a deleted last
+//	slot is trimmed rather than chained.
+bool HeapDriver::PageTestFreeSlots()
+{
+    cout << "  - Reuse of empty slots\n";
+    char buffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    RecordID rid;
+    Rec rec;
+    bool ok = true;
+
+    page->Init( 1 );
+    for ( int i = 0; i < 6; i++ )
+	{
+        MakeRec( rec, i );
+        ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK
+                        && rid.slotNo == i, "Insert did not take the next new slot" ) && ok;
+	}
+
+    int full = page->AvailableSpace();
+    int deleted[] = { 1, 3, 4 };
+    for ( int i = 0; i < 3; i++ )
+	{
+        rid.slotNo = deleted[i];
+        ok = PageCheck( page->DeleteRecord( rid ) == OK, "Deleting a middle record failed" ) && ok;
+	}
+
+    // the slots stay in the directory, so only the records' bytes come back
+    int space = page->AvailableSpace();
+    ok = PageCheck( space == full + 3*reclen, "Deleting middle records freed their slots" ) && ok;
+
+    for ( int i = 2; i >= 0; i-- )
+	{
+        MakeRec( rec, 10 + i );
+        ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK
+                        && rid.slotNo == deleted[i], "Insert did not reuse empty slots in LIFO order" ) && ok;
+	}
+    ok = PageCheck( page->AvailableSpace() == full, "Reusing empty slots added new ones" ) && ok;
+
+    rid.slotNo = 5;
+    ok = PageCheck( page->DeleteRecord( rid ) == OK, "Deleting the last record failed" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == full + reclen + 4, "Deleting the last record did not trim its slot" ) && ok;
+
+    // slot 5 is appended again, at the cost of a new slot
+    MakeRec( rec, 5 );
+    ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK && rid.slotNo == 5
+                    && page->AvailableSpace() == full, "Insert after trimming did not append a new slot" ) && ok;
+    return ok;
+}
+
+
+//	Get a pointer to the record in the given slot, to see where it lies.
+static const char* PageRecordPointer( HeapPage* page, PageID pageNo, int slotNo )
+{
+    RecordID rid;
+    char* recPtr;
+    int len;
+    rid.pageNo = pageNo;
+    rid.slotNo = slotNo;
+    return ( page->ReturnRecord( rid, recPtr, len ) == OK ) ? recPtr : NULL;
+}
+
+
+//	Deleting a record frees its bytes but leaves a hole; only the space
+//	after the last record can be used as it is, and a record that needs
+//	the holes is inserted after compacting the page.
+bool HeapDriver::PageTestCompaction()
+{
+    cout << "  - Compaction of a fragmented page\n";
+    const int length = 200;
+    char buffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    char record[MAX_SPACE];
+    RecordID rid;
+    bool ok = true;
+
+    page->Init( 2 );
+    int count = FillPage( page, length );
+    ok = PageCheck( count > 4, "Page took too few records" ) && ok;
+
+    int space = page->AvailableSpace();
+    ok = PageCheck( space < length + 4, "A full page reports the wrong free space" ) && ok;
+    const char* second = PageRecordPointer( page, 2, 2 );
+
+    rid.pageNo = 2;
+    rid.slotNo = 1;
+    ok = PageCheck( page->DeleteRecord( rid ) == OK, "Deleting a middle record failed" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == space + length, "Deleting a middle record did not free its bytes" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 2, 2 ) == second, "Deleting a middle record moved the others" ) && ok;
+
+    rid.slotNo = count - 1;
+    ok = PageCheck( page->DeleteRecord( rid ) == OK, "Deleting the last record failed" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == space + 2*length + 4, "Deleting the last record did not free its bytes and slot" ) && ok;
+
+    rid.slotNo = 3;
+    ok = PageCheck( page->DeleteRecord( rid ) == OK, "Deleting a middle record failed" ) && ok;
+
+    // exactly the space after the last record: stored there, nothing moves
+    const char* last = PageRecordPointer( page, 2, count - 2 );
+    int tailLength = space + length + 4;
+    memset( record, 'a' + 3, tailLength );
+    ok = PageCheck( page->InsertRecord( record, tailLength, rid ) == OK && rid.slotNo == 3
+                    && PageRecordPointer( page, 2, 3 ) == last + length
+                    && PageRecordPointer( page, 2, 2 ) == second, "Insert into the space after the last record failed" ) && ok;
+
+    // what is left is in the two holes, usable only once they are squeezed together
+    int bigLength = page->AvailableSpace();
+    ok = PageCheck( bigLength == 2*length, "Holes left by deletes were not counted as free" ) && ok;
+    memset( record, 'a' + 1, bigLength );
+    ok = PageCheck( page->InsertRecord( record, bigLength, rid ) == OK && rid.slotNo == 1,
+                    "Insert that needs compaction failed" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 2, 2 ) == PageRecordPointer( page, 2, 0 ) + length
+                    && page->AvailableSpace() == 0, "Compaction did not close the holes" ) && ok;
+
+    for ( int i = 0; i < count - 1; i++ )
+	{
+        int recLength = ( i == 1 ) ? bigLength : ( i == 3 ) ? tailLength : length;
+        ok = PageCheck( PageRecordIntact( page, 2, i, recLength ), "Compaction damaged a record" ) && ok;
+	}
+    return ok;
+}
+
+
+//	The record count and IsEmpty follow inserts, deletes and updates, and
+//	FirstRecord skips a deleted slot 0.
+bool HeapDriver::PageTestRecordCount()
+{
+    cout << "  - Record count and first record\n";
+    char buffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    char record[MAX_SPACE];
+    RecordID rid, first;
+    bool ok = true;
+
+    page->Init( 3 );
+    ok = PageCheck( page->IsEmpty() && page->GetNumOfRecords() == 0, "A new page is not empty" ) && ok;
+    ok = PageCheck( page->FirstRecord( first ) == DONE, "FirstRecord found a record on an empty page" ) && ok;
+
+    for ( int i = 0; i < 4; i++ )
+	{
+        memset( record, 'a' + i, 50 );
+        page->InsertRecord( record, 50, rid );
+        ok = PageCheck( page->GetNumOfRecords() == i + 1 && !page->IsEmpty(), "Insert did not count the record" ) && ok;
+	}
+
+    rid.pageNo = 3;
+    rid.slotNo = 0;
+    page->DeleteRecord( rid );
+    ok = PageCheck( page->GetNumOfRecords() == 3, "Delete did not count the record" ) && ok;
+    ok = PageCheck( page->FirstRecord( first ) == OK && first.slotNo == 1, "FirstRecord returned a deleted slot 0" ) && ok;
+
+    rid.slotNo = 2;
+    memset( record, 'c', 120 );
+    ok = PageCheck( page->UpdateRecord( rid, record, 120 ) == OK && page->GetNumOfRecords() == 3,
+                    "Growing a record changed the record count" ) && ok;
+    ok = PageCheck( page->UpdateRecord( rid, record, 10 ) == OK && page->GetNumOfRecords() == 3,
+                    "Shrinking a record changed the record count" ) && ok;
+
+    memset( record, 'e', 50 );
+    ok = PageCheck( page->InsertRecord( record, 50, rid ) == OK && rid.slotNo == 0
+                    && page->GetNumOfRecords() == 4, "Reinsert into slot 0 was not counted" ) && ok;
+    ok = PageCheck( page->FirstRecord( first ) == OK && first.slotNo == 0, "FirstRecord missed the reused slot 0" ) && ok;
+
+    for ( int i = 0; i < 4; i++ )
+	{
+        rid.slotNo = i;
+        page->DeleteRecord( rid );
+	}
+    ok = PageCheck( page->IsEmpty() && page->GetNumOfRecords() == 0, "Page is not empty after deleting every record" ) && ok;
+    ok = PageCheck( page->FirstRecord( first ) == DONE, "FirstRecord found a record on an emptied page" ) && ok;
+    return ok;
+}
+
+
+//	Updates shrink in place, grow in place at the end of the data area,
+//	grow through a compaction (even from a record on the same page), and
+//	leave the page untouched when the record cannot fit.
+bool HeapDriver::PageTestUpdate()
+{
+    cout << "  - Updating records in place and by moving them\n";
+    char buffer[MAX_SPACE], saved[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    char record[MAX_SPACE], expected[MAX_SPACE];
+    RecordID rid;
+    int len;
+    bool ok = true;
+
+    page->Init( 4 );
+    for ( int i = 0; i < 4; i++ )
+	{
+        memset( record, 'a' + i, 100 );
+        page->InsertRecord( record, 100, rid );
+	}
+    rid.pageNo = 4;
+
+    // shrink: same offset, the tail is given back to free space
+    rid.slotNo = 1;
+    const char* where = PageRecordPointer( page, 4, 1 );
+    int space = page->AvailableSpace();
+    memset( record, 'B', 60 );
+    ok = PageCheck( page->UpdateRecord( rid, record, 60 ) == OK, "Shrinking a record failed" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 4, 1 ) == where
+                    && page->AvailableSpace() == space + 40, "Shrinking did not happen in place" ) && ok;
+    ok = PageCheck( page->GetRecord( rid, expected, len ) == OK && len == 60
+                    && memcmp( expected, record, 60 ) == 0, "Shrunk record reads back wrong" ) && ok;
+
+    // grow the last record in the data area: it stays where it is, and
+    // the next record goes right after its new end
+    rid.slotNo = 3;
+    where = PageRecordPointer( page, 4, 3 );
+    memset( record, 'D', 150 );
+    ok = PageCheck( page->UpdateRecord( rid, record, 150 ) == OK, "Growing the last record failed" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 4, 3 ) == where, "Growing the last record did not happen in place" ) && ok;
+    memset( record, 'a' + 4, 100 );
+    ok = PageCheck( page->InsertRecord( record, 100, rid ) == OK && rid.slotNo == 4
+                    && PageRecordPointer( page, 4, 4 ) == where + 150, "Growing the last record left a gap after it" ) && ok;
+
+    // too big for the page: DONE, and not a byte changes
+    rid.slotNo = 0;
+    memcpy( saved, buffer, MAX_SPACE );
+    memset( record, 'A', page->AvailableSpace() + 101 );
+    ok = PageCheck( page->UpdateRecord( rid, record, page->AvailableSpace() + 101 ) == DONE,
+                    "Update of a record that cannot fit did not return DONE" ) && ok;
+    ok = PageCheck( memcmp( saved, buffer, MAX_SPACE ) == 0, "Failed update changed the page" ) && ok;
+
+    // fill the page up, then punch holes that are only usable together
+    int slots = 5;
+    for ( ;; slots++ )
+	{
+        memset( record, 'a' + slots % 26, 100 );
+        if ( page->InsertRecord( record, 100, rid ) != OK )
+            break;
+	}
+    rid.slotNo = 2;
+    page->DeleteRecord( rid );
+    rid.slotNo = 1;
+    page->DeleteRecord( rid );
+
+    // grow slot 0 from the bytes of slots 4 and 5, which Compact moves
+    char* source;
+    rid.slotNo = 4;
+    page->ReturnRecord( rid, source, len );
+    memcpy( expected, source, 200 );
+    ok = PageCheck( page->AvailableSpace() < 200 && page->AvailableSpace() + 100 >= 200,
+                    "Page is not fragmented" ) && ok;
+    rid.slotNo = 0;
+    ok = PageCheck( page->UpdateRecord( rid, source, 200 ) == OK, "Growing a record through compaction failed" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 4, 4 ) != source, "Growing a record did not compact the page" ) && ok;
+    ok = PageCheck( page->GetRecord( rid, record, len ) == OK && len == 200
+                    && memcmp( record, expected, 200 ) == 0, "Record grown from the page itself reads back wrong" ) && ok;
+
+    for ( int i = 4; i < slots; i++ )
+	{
+        rid.slotNo = i;
+        memset( expected, 'a' + i % 26, 100 );
+        ok = PageCheck( page->GetRecord( rid, record, len ) == OK && len == 100
+                        && memcmp( record, expected, 100 ) == 0, "Growing a record damaged another one" ) && ok;
+	}
+    return ok;
+}
+
+
+//	A batch insert on a fragmented page takes the empty slots first, then
+//	new ones, compacts to make the holes usable, and stops at the first
+//	record that does not fit.
+bool HeapDriver::PageTestInsertBatch()
+{
+    cout << "  - Inserting a batch of records\n";
+    char buffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    char record[MAX_SPACE], batch[4][MAX_SPACE];
+    const char* recPtrs[4];
+    int recLens[4];
+    RecordID rid, rids[4];
+    int len;
+    bool ok = true;
+
+    page->Init( 5 );
+    int count = FillPage( page, 100 );
+    rid.pageNo = 5;
+    rid.slotNo = 1;
+    page->DeleteRecord( rid );
+    rid.slotNo = 3;
+    page->DeleteRecord( rid );
+
+    // two records for the empty slots, one that takes the rest of the
+    // page with a new slot, and one that is left over
+    recLens[0] = 90;
+    recLens[1] = 90;
+    recLens[2] = page->AvailableSpace() - 2*90 - 4;
+    recLens[3] = 1;
+    for ( int i = 0; i < 4; i++ )
+	{
+        memset( batch[i], 'A' + i, recLens[i] );
+        recPtrs[i] = batch[i];
+	}
+    ok = PageCheck( recLens[2] > 0, "Page is not fragmented" ) && ok;
+
+    int inserted = page->InsertRecords( recPtrs, recLens, 4, rids );
+    ok = PageCheck( inserted == 3, "Batch insert did not stop at the record that does not fit" ) && ok;
+    ok = PageCheck( rids[0].slotNo == 3 && rids[1].slotNo == 1 && rids[2].slotNo == count,
+                    "Batch insert did not reuse empty slots before adding one" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == 0 && page->GetNumOfRecords() == count + 1,
+                    "Batch insert left the space or count wrong" ) && ok;
+    ok = PageCheck( PageRecordPointer( page, 5, 2 ) == PageRecordPointer( page, 5, 0 ) + 100,
+                    "Batch insert did not compact the page" ) && ok;
+
+    for ( int i = 0; i < 3; i++ )
+	{
+        ok = PageCheck( page->GetRecord( rids[i], record, len ) == OK && len == recLens[i]
+                        && memcmp( record, batch[i], len ) == 0, "Batch record reads back wrong" ) && ok;
+	}
+    for ( int i = 0; i < count; i++ )
+	{
+        if ( i == 1 || i == 3 )
+            continue;
+        ok = PageCheck( PageRecordIntact( page, 5, i, 100 ), "Batch insert damaged a record" ) && ok;
+	}
+
+    ok = PageCheck( page->InsertRecords( recPtrs + 3, recLens + 3, 1, rids ) == 0,
+                    "Batch insert into a full page inserted something" ) && ok;
+    return ok;
+}
+
+
+//	A FIXED_LAYOUT page rejects lengths that cannot fit, takes the first
+//	empty position on insert, walks its occupancy bitmap, and counts the
+//	records it holds; all through the HeapPage interface.
+bool HeapDriver::PageTestFixed()
+{
+    cout << "  - Fixed-length records\n";
+    char buffer[MAX_SPACE];
+    FixedPage* fixed = (FixedPage*)buffer;
+    HeapPage* page = fixed;
+    Rec rec, out;
+    RecordID rid, next;
+    char* recPtr;
+    int len;
+    bool ok = true;
+
+    ok = PageCheck( fixed->Init( 6, 0 ) == FAIL && fixed->Init( 6, -1 ) == FAIL
+                    && fixed->Init( 6, HEAPPAGE_DATA_SIZE ) == FAIL, "Init accepted a record length that cannot fit" ) && ok;
+    ok = PageCheck( fixed->Init( 6, HEAPPAGE_DATA_SIZE - 12 ) == OK && fixed->NumOfSlots() == 1,
+                    "Init of a page with room for one record failed" ) && ok;
+
+    ok = PageCheck( fixed->Init( 6, reclen ) == OK, "Init failed" ) && ok;
+    int slots = fixed->NumOfSlots();
+    ok = PageCheck( page->IsEmpty() && page->AvailableSpace() == slots * reclen, "A new fixed page is not empty" ) && ok;
+    ok = PageCheck( page->InsertRecord( (char*)&rec, reclen - 1, rid ) == FAIL, "Insert of the wrong length succeeded" ) && ok;
+
+    for ( int i = 0; i < slots; i++ )
+	{
+        MakeRec( rec, i );
+        ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK && rid.slotNo == i,
+                        "Insert did not take the next position" ) && ok;
+	}
+    ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == DONE, "Insert into a full page did not return DONE" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == 0 && page->GetNumOfRecords() == slots, "A full fixed page reports the wrong count" ) && ok;
+
+    int deleted[] = { 0, 5, slots - 1 };
+    rid.pageNo = 6;
+    for ( int i = 0; i < 3; i++ )
+	{
+        rid.slotNo = deleted[i];
+        ok = PageCheck( page->DeleteRecord( rid ) == OK, "Delete failed" ) && ok;
+	}
+    ok = PageCheck( page->DeleteRecord( rid ) == FAIL, "Deleting an empty position succeeded" ) && ok;
+    ok = PageCheck( page->GetNumOfRecords() == slots - 3
+                    && CountBits( fixed->GetOccupancy(), slots ) == slots - 3, "Delete left the record count wrong" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == 3 * reclen, "Delete did not free the position" ) && ok;
+
+    ok = PageCheck( page->FirstRecord( rid ) == OK && rid.slotNo == 1, "FirstRecord did not skip an empty position" ) && ok;
+    rid.slotNo = 4;
+    ok = PageCheck( page->NextRecord( rid, next ) == OK && next.slotNo == 6, "NextRecord did not skip an empty position" ) && ok;
+    rid.slotNo = slots - 2;
+    ok = PageCheck( page->NextRecord( rid, next ) == DONE, "NextRecord went past the last record" ) && ok;
+
+    rid.slotNo = 7;
+    MakeRec( rec, 7 );
+    ok = PageCheck( page->GetRecord( rid, (char*)&out, len ) == OK && len == reclen
+                    && memcmp( &out, &rec, reclen ) == 0, "GetRecord read back the wrong record" ) && ok;
+    ok = PageCheck( page->ReturnRecord( rid, recPtr, len ) == OK && len == reclen
+                    && memcmp( recPtr, &rec, reclen ) == 0, "ReturnRecord pointed at the wrong record" ) && ok;
+
+    MakeRec( rec, 100 );
+    ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK && rid.slotNo == 0
+                    && page->GetNumOfRecords() == slots - 2, "Insert did not take the first empty position" ) && ok;
+    return ok;
+}
+
+
+//	Predicates combine their conditions with AND, OR and NOT, stopping at
+//	the first one that decides, and fail a field past the record's end.
+bool HeapDriver::PageTestPredicate()
+{
+    cout << "  - Predicates on records\n";
+    const int ioff = offsetof( Rec, ival ), foff = offsetof( Rec, fval ), noff = offsetof( Rec, name );
+    Rec rec;
+    bool ok = true;
+    MakeRec( rec, 7 );      // ival 7, fval 17.5, name "record 7"
+    const char* recPtr = (const char*)&rec;
+
+    Predicate typed;
+    ok = PageCheck( typed.AddCondition( ioff, attrInteger, aopEQ, 7.5 ) == FAIL
+                    && typed.AddCondition( ioff, attrString, aopEQ, 7 ) == FAIL
+                    && typed.AddCondition( noff, namelen, attrInteger, aopEQ, "record 7" ) == FAIL
+                    && typed.AddCondition( ioff, attrInteger, aopNOT, 7 ) == FAIL,
+                    "AddCondition accepted a type or operator that does not fit" ) && ok;
+    ok = PageCheck( typed.AddCondition( foff, attrReal, aopEQ, 17.5 ) == OK
+                    && typed.AddCondition( ioff, attrInteger, aopEQ, 7 ) == OK
+                    && typed.Matches( recPtr, reclen ), "Conditions of explicit types did not match" ) && ok;
+
+    Predicate range;
+    range.AddCondition( ioff, attrInteger, opRANGE, 7, 9 );
+    range.AddCondition( foff, attrReal, opRANGE, 10, 17.5 );
+    range.AddCondition( noff, namelen, attrString, opRANGE, "record 5", "record 7" );
+    ok = PageCheck( range.Matches( recPtr, reclen ), "opRANGE did not include its bounds" ) && ok;
+    Predicate outside;
+    outside.AddCondition( ioff, attrInteger, opRANGE, 8, 9 );
+    ok = PageCheck( !outside.Matches( recPtr, reclen ), "opRANGE matched a value below its range" ) && ok;
+
+    // the first condition decides AND when it fails and OR when it holds
+    Predicate both, either( lopOR ), neither( lopNOT ), notAll( lopNOT );
+    both.AddCondition( ioff, attrInteger, aopGT, 10 );
+    both.AddCondition( foff, attrReal, aopGT, 0 );
+    either.AddCondition( ioff, attrInteger, aopLT, 10 );
+    either.AddCondition( foff, attrReal, aopLT, 0 );
+    neither.AddCondition( ioff, attrInteger, aopGT, 10 );
+    neither.AddCondition( foff, attrReal, aopGT, 0 );
+    ok = PageCheck( !both.Matches( recPtr, reclen ), "AND matched with its first condition failing" ) && ok;
+    ok = PageCheck( either.Matches( recPtr, reclen ), "OR failed with its first condition holding" ) && ok;
+    ok = PageCheck( neither.Matches( recPtr, reclen ), "NOT failed with one condition failing" ) && ok;
+    notAll.AddCondition( ioff, attrInteger, aopGT, 0 );
+    notAll.AddCondition( foff, attrReal, aopGT, 0 );
+    ok = PageCheck( !notAll.Matches( recPtr, reclen ), "NOT matched with every condition holding" ) && ok;
+
+    // the name runs past a record cut short before it
+    Predicate past;
+    past.AddCondition( noff, namelen, attrString, aopNE, "x" );
+    ok = PageCheck( past.Matches( recPtr, reclen ) && !past.Matches( recPtr, noff + namelen - 1 ),
+                    "A field past the end of the record did not fail" ) && ok;
+    return ok;
+}
+
+
+//	Every SIMD level of FilterColumn gives the same mask as the scalar
+//	kernel, for packed and strided values, counts that leave a partial
+//	mask word, and reals that include NaN.
+bool HeapDriver::PageTestFilterKernels()
+{
+    cout << "  - Vectorized filter kernels\n";
+    const int maxCount = 101;
+    const int ints[] = { 0, 1, -1, 7, 8, 9, 1000, INT_MIN, INT_MAX };
+    const double reals[] = { 0.0, -0.0, 1.5, 7.0, 8.0, 9.0, -1e300, 1e300, NAN };
+    const AttrOperator ops[] = { aopEQ, aopNE, aopLT, aopGT, aopLE, aopGE, opRANGE };
+    const int counts[] = { 1, 31, 32, 33, 64, 95, maxCount };
+    static int packedInts[maxCount];
+    static double packedReals[maxCount];
+    static Rec recs[maxCount];
+    uint expected[BitmapWords( maxCount )], mask[BitmapWords( maxCount )];
+    bool ok = true;
+
+    for ( int i = 0; i < maxCount; i++ )
+	{
+        packedInts[i] = ints[i % 9];
+        packedReals[i] = reals[i % 9];
+        MakeRec( recs[i], ints[(i * 5) % 9] );
+        recs[i].fval = reals[(i * 5) % 9];
+	}
+
+    SimdLevel level = SetFilterSimdLevel( SIMD_AVX2 );
+    for ( int o = 0; o < 7; o++ )
+	for ( int real = 0; real < 2; real++ )
+	for ( int s = 0; s < 2; s++ )
+	for ( int c = 0; c < 7; c++ )
+	{
+        // values packed back to back, or a field of the records
+        const char* base;
+        int stride;
+        if ( s == 0 )
+		{
+            base = real ? (const char*)packedReals : (const char*)packedInts;
+            stride = real ? sizeof(double) : sizeof(int);
+		}
+        else
+		{
+            base = real ? (const char*)&recs[0].fval : (const char*)&recs[0].ival;
+            stride = reclen;
+		}
+        Condition cond;
+        if ( real )
+            cond.Init( 0, attrReal, ops[o], 7.0, 9.0 );
+        else
+            cond.Init( 0, attrInteger, ops[o], 7, 9 );
+
+        SetFilterSimdLevel( SIMD_NONE );
+        FilterColumn( base, stride, counts[c], cond, expected );
+        for ( int simd = SIMD_SSE2; simd <= SIMD_AVX2; simd++ )
+		{
+            SetFilterSimdLevel( (SimdLevel)simd );
+            ok = PageCheck( FilterColumn( base, stride, counts[c], cond, mask ) == OK
+                            && memcmp( mask, expected, BitmapWords( counts[c] ) * sizeof(uint) ) == 0,
+                            "A vectorized filter kernel disagrees with the scalar one" ) && ok;
+		}
+	}
+    SetFilterSimdLevel( level );
+    return ok;
+}
+
+
+//	A PAX_LAYOUT page rebuilds whole rows through the HeapPage interface,
+//	hands out an attribute's minipage, and filters on an attribute found
+//	by its offset in the row, as a FixedPage does on the same records.
+bool HeapDriver::PageTestPax()
+{
+    cout << "  - Rows split across minipages\n";
+    char buffer[MAX_SPACE], saved[MAX_SPACE], fixedBuffer[MAX_SPACE];
+    PaxPage* pax = (PaxPage*)buffer;
+    HeapPage* page = pax;
+    FixedPage* fixed = (FixedPage*)fixedBuffer;
+    AttrDesc attrs[MAX_PAX_ATTRS];
+    Rec rec, out;
+    RecordID rid;
+    int len;
+    bool ok = true;
+
+    // a schema that does not fit leaves the page as it was
+    page->Init( 7 );
+    MakeRec( rec, 1 );
+    page->InsertRecord( (char*)&rec, reclen, rid );
+    for ( int i = 0; i < MAX_PAX_ATTRS; i++ )
+	{
+        attrs[i].type = attrString;
+        attrs[i].offset = 0;
+        attrs[i].length = HEAPPAGE_DATA_SIZE / MAX_PAX_ATTRS;
+	}
+    memcpy( saved, buffer, MAX_SPACE );
+    ok = PageCheck( pax->Init( 7, attrs, MAX_PAX_ATTRS, HEAPPAGE_DATA_SIZE ) == FAIL
+                    && memcmp( saved, buffer, MAX_SPACE ) == 0, "Init of a schema that does not fit changed the page" ) && ok;
+
+    attrs[0].type = attrInteger;
+    attrs[0].offset = offsetof( Rec, ival );
+    attrs[0].length = sizeof(int);
+    attrs[1].type = attrReal;
+    attrs[1].offset = offsetof( Rec, fval );
+    attrs[1].length = sizeof(double);
+    attrs[2].type = attrString;
+    attrs[2].offset = offsetof( Rec, name );
+    attrs[2].length = namelen;
+    ok = PageCheck( pax->Init( 7, attrs, 3, reclen ) == OK, "Init failed" ) && ok;
+    fixed->Init( 8, reclen );
+
+    int rows = pax->NumOfSlots();
+    ok = PageCheck( rows > 0 && page->AvailableSpace() == rows * reclen, "A new PAX page is not empty" ) && ok;
+    for ( int i = 0; i < rows; i++ )
+	{
+        MakeRec( rec, i );
+        ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == OK && rid.slotNo == i,
+                        "Insert did not take the next row" ) && ok;
+        if ( i < fixed->NumOfSlots() )
+            fixed->InsertRecord( (char*)&rec, reclen, rid );
+	}
+    ok = PageCheck( page->InsertRecord( (char*)&rec, reclen, rid ) == DONE, "Insert into a full PAX page did not return DONE" ) && ok;
+    ok = PageCheck( page->AvailableSpace() == 0 && page->GetNumOfRecords() == rows, "A full PAX page reports the wrong count" ) && ok;
+    rid.pageNo = 7;
+    for ( int i = 0; i < rows; i += 3 )
+	{
+        rid.slotNo = i;
+        page->DeleteRecord( rid );
+        fixed->DeleteRecord( rid );
+	}
+
+    for ( int i = 0; i < rows; i++ )
+	{
+        rid.slotNo = i;
+        MakeRec( rec, i );
+        Status status = page->GetRecord( rid, (char*)&out, len );
+        ok = PageCheck( ( i % 3 == 0 ) ? status == FAIL
+                        : status == OK && len == reclen && memcmp( &out, &rec, reclen ) == 0,
+                        "A row rebuilt from the minipages is wrong" ) && ok;
+	}
+
+    const char* values;
+    ok = PageCheck( pax->GetColumn( 1, values, len ) == OK && len == sizeof(double), "GetColumn failed" ) && ok;
+    for ( int i = 1; i < rows; i += 3 )
+	{
+        double fval;
+        memcpy( &fval, values + i * len, sizeof(double) );
+        ok = PageCheck( fval == i*2.5, "GetColumn returned the wrong values" ) && ok;
+	}
+    ok = PageCheck( pax->GetColumn( 3, values, len ) == FAIL, "GetColumn of a missing attribute succeeded" ) && ok;
+
+    // fval between 25 and 100 is rows 10 to 40, less every third one
+    Condition cond, misplaced, mistyped;
+    cond.Init( offsetof( Rec, fval ), attrReal, opRANGE, 25, 100 );
+    misplaced.Init( offsetof( Rec, fval ) + 4, attrReal, aopEQ, 0 );
+    mistyped.Init( offsetof( Rec, fval ), attrInteger, aopEQ, 0 );
+    uint mask[BitmapWords( MAX_SPACE )], fixedMask[BitmapWords( MAX_SPACE )];
+    ok = PageCheck( pax->Filter( cond, mask ) == OK, "Filter failed" ) && ok;
+    ok = PageCheck( fixed->Filter( cond, fixedMask ) == OK, "Filter of the fixed page failed" ) && ok;
+    for ( int i = 0; i < rows; i++ )
+	{
+        bool expected = i >= 10 && i <= 40 && i % 3 != 0;
+        ok = PageCheck( TestBit( mask, i ) == expected, "Filter matched the wrong rows" ) && ok;
+        if ( i < fixed->NumOfSlots() )
+            ok = PageCheck( TestBit( fixedMask, i ) == expected, "Filter of the fixed page matched the wrong records" ) && ok;
+	}
+    ok = PageCheck( CountBits( mask, rows ) == 21, "Filter matched the wrong number of rows" ) && ok;
+    ok = PageCheck( pax->Filter( misplaced, mask ) == FAIL && pax->Filter( mistyped, mask ) == FAIL,
+                    "Filter on no attribute succeeded" ) && ok;
+    return ok;
+}
+
+
+//	Walk the page with the iterator next to FirstRecord and NextRecord,
+//	checking that each record it returns is the next one, at the pointer
+//	and length ReturnRecord gives. Returns the count, or -1 on a mismatch.
+static int PageIterate( HeapPage* page, HeapPageIterator& iter )
+{
+    RecordID rid, expected;
+    char* recPtr;
+    const char* ptr;
+    int len, recLen, count = 0;
+    Status status = page->FirstRecord( expected );
+    while ( ( ptr = iter( rid, len ) ) != NULL )
+	{
+        if ( status != OK || rid.pageNo != expected.pageNo || rid.slotNo != expected.slotNo
+             || page->ReturnRecord( rid, recPtr, recLen ) != OK || ptr != recPtr || len != recLen )
+            return -1;
+        count++;
+        status = page->NextRecord( expected, expected );
+	}
+    if ( status != DONE || iter.GetStatus() != DONE || iter( rid, len ) != NULL )
+        return -1;
+    return count;
+}
+
+
+//	The iterator points at the records in place, skipping empty slots
+//	(the first one included) on slotted and fixed-length pages, and
+//	tells a PAX page it cannot walk from one that ran out of records.
+bool HeapDriver::PageTestIterator()
+{
+    cout << "  - Iterating over the records of a page\n";
+    char buffer[MAX_SPACE], fixedBuffer[MAX_SPACE], paxBuffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    FixedPage* fixed = (FixedPage*)fixedBuffer;
+    PaxPage* pax = (PaxPage*)paxBuffer;
+    char record[MAX_SPACE];
+    AttrDesc attr;
+    RecordID rid;
+    Rec rec;
+    int len;
+    bool ok = true;
+
+    page->Init( 9 );
+    HeapPageIterator empty( page );
+    ok = PageCheck( empty( rid, len ) == NULL && empty.GetStatus() == DONE, "Iterating an empty page did not end with DONE" ) && ok;
+
+    for ( int i = 0; i < 12; i++ )
+	{
+        memset( record, 'a' + i, 20 + 3*i );
+        page->InsertRecord( record, 20 + 3*i, rid );
+	}
+    int deleted[] = { 0, 4, 5, 9, 11 };
+    for ( int i = 0; i < 5; i++ )
+	{
+        rid.slotNo = deleted[i];
+        page->DeleteRecord( rid );
+	}
+    HeapPageIterator rows( page );
+    ok = PageCheck( PageIterate( page, rows ) == 7, "Iterating a slotted page returned the wrong records" ) && ok;
+
+    fixed->Init( 10, reclen );
+    int slots = fixed->NumOfSlots();
+    for ( int i = 0; i < slots; i++ )
+	{
+        MakeRec( rec, i );
+        fixed->InsertRecord( (char*)&rec, reclen, rid );
+	}
+    int holes[] = { 0, 3, 4, slots - 1 };
+    for ( int i = 0; i < 4; i++ )
+	{
+        rid.slotNo = holes[i];
+        fixed->DeleteRecord( rid );
+	}
+    HeapPageIterator records( fixed );
+    ok = PageCheck( PageIterate( fixed, records ) == slots - 4, "Iterating a fixed page returned the wrong records" ) && ok;
+
+    attr.type = attrInteger;
+    attr.offset = offsetof( Rec, ival );
+    attr.length = sizeof(int);
+    pax->Init( 11, &attr, 1, reclen );
+    MakeRec( rec, 1 );
+    pax->InsertRecord( (char*)&rec, reclen, rid );
+    HeapPageIterator split( pax );
+    ok = PageCheck( split( rid, len ) == NULL && split.GetStatus() == FAIL, "Iterating a PAX page did not fail" ) && ok;
+    return ok;
+}
+
+
+//	Check that the batch holds the records numbered from next on, as
+//	inserted by PageTestBatch, and count them off.
+static bool PageBatchInOrder( RecordBatch& batch, int& next, int length )
+{
+    for ( int i = 0; i < batch.numOfRecords; i++, next++ )
+	{
+        int number;
+        memcpy( &number, batch.recPtrs[i], sizeof(int) );
+        if ( number != next || batch.recLens[i] != length )
+            return false;
+	}
     return true;
 }
+
+
+//	One batch gathers the records of several pages: FillBatch returns OK
+//	when the batch fills up in the middle of a page, and picks up where it
+//	left off once the caller has drained it.
+bool HeapDriver::PageTestBatch()
+{
+    cout << "  - Gathering records of several pages into batches\n";
+    const int numOfPages = 8, length = 20;
+    static char buffers[numOfPages][MAX_SPACE];
+    static RecordBatch batch;
+    char record[length];
+    RecordID rid;
+    bool ok = true;
+
+    int total = 0;
+    for ( int p = 0; p < numOfPages; p++ )
+	{
+        HeapPage* page = (HeapPage*)buffers[p];
+        page->Init( 20 + p );
+        memset( record, 0, length );
+        memcpy( record, &total, sizeof(int) );
+        while ( page->InsertRecord( record, length, rid ) == OK )
+		{
+            total++;
+            memcpy( record, &total, sizeof(int) );
+		}
+	}
+    ok = PageCheck( total > RECORD_BATCH_SIZE, "The pages hold fewer records than a batch" ) && ok;
+
+    int next = 0, full = 0;
+    batch.Clear();
+    for ( int p = 0; p < numOfPages; p++ )
+	{
+        HeapPageIterator iter( (HeapPage*)buffers[p] );
+        Status status;
+        while ( ( status = iter.FillBatch( batch ) ) == OK )
+		{
+            ok = PageCheck( batch.IsFull(), "FillBatch returned OK before the batch was full" ) && ok;
+            ok = PageCheck( batch.rids[batch.numOfRecords - 1].pageNo == 20 + p, "A full batch did not end on the current page" ) && ok;
+            ok = PageCheck( PageBatchInOrder( batch, next, length ), "A full batch held the wrong records" ) && ok;
+            full++;
+            batch.Clear();
+		}
+        ok = PageCheck( status == DONE, "FillBatch did not end the page with DONE" ) && ok;
+	}
+    ok = PageCheck( PageBatchInOrder( batch, next, length ) && next == total, "The batches missed records" ) && ok;
+    ok = PageCheck( full == total / RECORD_BATCH_SIZE, "The batches did not fill up across pages" ) && ok;
+
+    // a fixed page is gathered over its occupancy bitmap
+    char fixedBuffer[MAX_SPACE];
+    FixedPage* fixed = (FixedPage*)fixedBuffer;
+    Rec rec;
+    fixed->Init( 29, reclen );
+    for ( int i = 0; i < 10; i++ )
+	{
+        MakeRec( rec, i );
+        fixed->InsertRecord( (char*)&rec, reclen, rid );
+	}
+    rid.slotNo = 0;
+    fixed->DeleteRecord( rid );
+    HeapPageIterator records( fixed );
+    batch.Clear();
+    ok = PageCheck( records.FillBatch( batch ) == DONE && batch.numOfRecords == 9
+                    && batch.rids[0].slotNo == 1 && batch.recPtrs[8] == PageRecordPointer( fixed, 29, 9 ),
+                    "FillBatch of a fixed page gathered the wrong records" ) && ok;
+
+    // a PAX page cannot be gathered by pointer, and leaves the batch alone
+    char paxBuffer[MAX_SPACE];
+    PaxPage* pax = (PaxPage*)paxBuffer;
+    AttrDesc attr;
+    attr.type = attrInteger;
+    attr.offset = offsetof( Rec, ival );
+    attr.length = sizeof(int);
+    pax->Init( 30, &attr, 1, reclen );
+    MakeRec( rec, 1 );
+    pax->InsertRecord( (char*)&rec, reclen, rid );
+    HeapPageIterator split( pax );
+    batch.Clear();
+    ok = PageCheck( split.FillBatch( batch ) == FAIL && batch.numOfRecords == 0, "FillBatch of a PAX page did not fail" ) && ok;
+    return ok;
+}
+
+
+//	Insert the records numbered 0 to count - 1, and delete the given
+//	ones again, so that slot i holds record i or is empty.
+static void PageFillRecs( HeapPage* page, int count, const int* deleted, int numOfDeleted )
+{
+    RecordID rid;
+    Rec rec;
+    for ( int i = 0; i < count; i++ )
+	{
+        MakeRec( rec, i );
+        page->InsertRecord( (char*)&rec, reclen, rid );
+	}
+    for ( int i = 0; i < numOfDeleted; i++ )
+	{
+        rid.slotNo = deleted[i];
+        page->DeleteRecord( rid );
+	}
+}
+
+
+//	An iterator given a predicate returns exactly the records that
+//	satisfy it, one by one and in batches, on slotted and fixed pages.
+bool HeapDriver::PageTestPushdown()
+{
+    cout << "  - Pushing a predicate down into the iterator\n";
+    char buffer[MAX_SPACE], fixedBuffer[MAX_SPACE];
+    HeapPage* page = (HeapPage*)buffer;
+    FixedPage* fixed = (FixedPage*)fixedBuffer;
+    HeapPage* pages[] = { page, fixed };
+    static RecordBatch batch;
+    const int count = 60;
+    int deleted[] = { 0, 10, 25, 40, 59 };
+    RecordID rid;
+    int len;
+    bool ok = true;
+
+    // ival between 10 and 40 is slots 10 to 40, less the deleted ones
+    bool expected[count];
+    for ( int i = 0; i < count; i++ )
+        expected[i] = i >= 10 && i <= 40 && i != 10 && i != 25 && i != 40;
+    Predicate pred;
+    pred.AddCondition( offsetof( Rec, ival ), attrInteger, opRANGE, 10, 40 );
+
+    page->Init( 12 );
+    PageFillRecs( page, count, deleted, 5 );
+    fixed->Init( 13, reclen );
+    PageFillRecs( fixed, count, deleted, 5 );
+
+    for ( int p = 0; p < 2; p++ )
+	{
+        HeapPageIterator iter( pages[p], &pred );
+        const char* recPtr;
+        int slotNo = 0, matched = 0;
+        while ( ( recPtr = iter( rid, len ) ) != NULL )
+		{
+            while ( slotNo < count && !expected[slotNo] )
+                slotNo++;
+            ok = PageCheck( rid.slotNo == slotNo && len == reclen && recPtr == PageRecordPointer( pages[p], rid.pageNo, slotNo ),
+                            "The iterator returned a record the predicate rejects" ) && ok;
+            slotNo++;
+            matched++;
+		}
+        ok = PageCheck( matched == 28 && iter.GetStatus() == DONE, "The iterator missed matching records" ) && ok;
+
+        HeapPageIterator batched( pages[p], &pred );
+        batch.Clear();
+        ok = PageCheck( batched.FillBatch( batch ) == DONE && batch.numOfRecords == 28, "FillBatch gathered the wrong number of records" ) && ok;
+        slotNo = 0;
+        for ( int i = 0; i < batch.numOfRecords; i++, slotNo++ )
+		{
+            while ( slotNo < count && !expected[slotNo] )
+                slotNo++;
+            ok = PageCheck( batch.rids[i].slotNo == slotNo && batch.recPtrs[i] == PageRecordPointer( pages[p], batch.rids[i].pageNo, slotNo ),
+                            "FillBatch gathered a record the predicate rejects" ) && ok;
+		}
+	}
+    return ok;
+}
@@ -0,0 +1,264 @@
+#include <iostream>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "paxpage.h"
+#include "filter.h"
+
+using namespace std;
+
+//------------------------------------------------------------------
+// PaxPage::Init
+//
+// Input     : Page ID, the schema (attributes and the row length).
+// Output    : None.
+// Purpose   : Inialize the page with given PageID, splitting the data
+//             area into one minipage per attribute, with room for as
+//             many rows as fit.
+// Return    : OK if successful, FAIL if the schema is invalid.
+//------------------------------------------------------------------
+
+Status PaxPage::Init(PageID pageNo, const AttrDesc *attrs, int numOfAttrs, int recLen)
+{
+	if (numOfAttrs <= 0 || numOfAttrs > MAX_PAX_ATTRS || recLen <= 0 || recLen > HEAPPAGE_DATA_SIZE) return FAIL;
+
+	int rowBytes = 0;                            // bytes of one row kept in the minipages
+	for (int i = 0; i < numOfAttrs; i++) {
+		if (attrs[i].offset < 0 || attrs[i].length <= 0 || attrs[i].offset + attrs[i].length > recLen) return FAIL;
+		rowBytes += attrs[i].length;
+	}
+
+	// lay the data area out before writing anything, so that a schema that does not fit
+	// leaves the page as it was; each row costs rowBytes plus one bit, and each minipage
+	// may lose up to 7 bytes to alignment
+	int fixed = sizeof(PaxHeader) + numOfAttrs * sizeof(PaxAttr);
+	int rows = (HEAPPAGE_DATA_SIZE - fixed - numOfAttrs * 7) * 8 / (rowBytes * 8 + 1);
+	int end = 0;
+	for (; rows > 0; rows--) {
+		end = fixed + BitmapWords(rows) * sizeof(uint);
+		for (int i = 0; i < numOfAttrs; i++) {
+			end = (end + 7) & ~7;
+			end += rows * attrs[i].length;
+		}
+		if (end <= HEAPPAGE_DATA_SIZE) break;
+	}
+	if (rows <= 0) return FAIL;
+
+	HeapPage::Init(pageNo);
+	type = PAX_LAYOUT;
+
+	PaxHeader *header = GetHeader();
+	header->numOfAttrs = numOfAttrs;
+	header->recLen = recLen;
+
+	PaxAttr *attr = GetAttrs();
+	int minipage = fixed + BitmapWords(rows) * sizeof(uint);
+	for (int i = 0; i < numOfAttrs; i++, attr++) {
+		minipage = (minipage + 7) & ~7;
+		attr->type = attrs[i].type;
+		attr->offset = attrs[i].offset;
+		attr->length = attrs[i].length;
+		attr->minipage = minipage;
+		minipage += rows * attrs[i].length;
+	}
+
+	header->numOfSlots = rows;                   // every row position is a slot
+	header->numOfRecords = 0;
+	freePtr = end;                               // the data area is laid out up to here
+	memset(GetBitmap(), 0, BitmapWords(rows) * sizeof(uint));  // all rows start empty
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::InsertRecord
+//
+// Input     : Pointer to the row and the row's length.
+// Output    : Record ID of the row inserted.
+// Purpose   : Split a row into its attributes and store each in its
+//             minipage, in the first empty row position.
+// Return    : OK if everything went OK, DONE if the page is full,
+//             FAIL if the row is not of this page's length.
+//------------------------------------------------------------------
+
+Status PaxPage::InsertRecord(const char *recPtr, int length, RecordID& rid)
+{
+	if (length != GetHeader()->recLen) return FAIL;
+
+	int slotNo = FindClearBit(GetBitmap(), GetHeader()->numOfSlots);   // first empty row
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	PaxAttr *attr = GetAttrs();
+	for (int i = 0; i < GetHeader()->numOfAttrs; i++, attr++) {
+		memcpy(GetValuePointer(attr, slotNo), recPtr + attr->offset, attr->length);
+	}
+
+	SetBit(GetBitmap(), slotNo);
+	GetHeader()->numOfRecords++;
+
+	rid.pageNo = PageNo();
+	rid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::DeleteRecord
+//
+// Input    : Record ID.
+// Output   : None.
+// Purpose  : Delete a row from the page.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status PaxPage::DeleteRecord(RecordID rid)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	ClearBit(GetBitmap(), rid.slotNo);
+	GetHeader()->numOfRecords--;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::UpdateRecord
+//
+// Input    : Record ID, pointer to the new row and its length.
+// Output   : None.
+// Purpose  : Overwrite a row on the page.
+// Return   : OK if successful, FAIL if there is no such row or the
+//            new row is not of this page's length.
+//------------------------------------------------------------------
+
+Status PaxPage::UpdateRecord(RecordID rid, const char *recPtr, int length)
+{
+	if (length != GetHeader()->recLen) return FAIL;
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	PaxAttr *attr = GetAttrs();
+	for (int i = 0; i < GetHeader()->numOfAttrs; i++, attr++) {
+		memcpy(GetValuePointer(attr, rid.slotNo), recPtr + attr->offset, attr->length);
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::FirstRecord
+//
+// Input    : None.
+// Output   : Record id of the first row on a page.
+// Purpose  : To find the first row on a page.
+// Return   : OK if successful, DONE otherwise.
+//------------------------------------------------------------------
+
+Status PaxPage::FirstRecord(RecordID& rid)
+{
+	int slotNo = FindSetBit(GetBitmap(), 0, GetHeader()->numOfSlots);
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	rid.pageNo = PageNo();
+	rid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::NextRecord
+//
+// Input    : ID of the current row.
+// Output   : ID of the next row.
+// Purpose  : To find the next row on a page.
+// Return   : Return DONE if no more rows exist on the page;
+//            otherwise OK.
+//------------------------------------------------------------------
+
+Status PaxPage::NextRecord(RecordID curRid, RecordID& nextRid)
+{
+	int slotNo = FindSetBit(GetBitmap(), curRid.slotNo + 1, GetHeader()->numOfSlots);
+	if (slotNo == GetHeader()->numOfSlots) return DONE;
+
+	nextRid.pageNo = PageNo();
+	nextRid.slotNo = slotNo;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::GetRecord
+//
+// Input    : rid - Record ID. len - the length of allocated memory.
+// Output   : Row's length and a copy of the row itself.
+// Purpose  : To rebuild a COPY of the row with ID rid from the
+//            minipages. Bytes of the row not covered by any attribute
+//            come back as zero.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status PaxPage::GetRecord(RecordID rid, char *recPtr, int& len)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= GetHeader()->numOfSlots || SlotIsEmpty(rid.slotNo)) return FAIL;
+
+	PaxHeader *header = GetHeader();
+	memset(recPtr, 0, header->recLen);
+	PaxAttr *attr = GetAttrs();
+	for (int i = 0; i < header->numOfAttrs; i++, attr++) {
+		memcpy(recPtr + attr->offset, GetValuePointer(attr, rid.slotNo), attr->length);
+	}
+	len = header->recLen;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::GetColumn
+//
+// Input    : Attribute number in the schema.
+// Output   : Pointer to the attribute's minipage, attribute's length.
+// Purpose  : To retrieve a POINTER to the values of one attribute in
+//            all rows; the value of row i is at values + i * length.
+//            Only rows set in GetOccupancy hold a value.
+// Return   : OK if successful, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status PaxPage::GetColumn(int attrNo, const char*& values, int& length)
+{
+	if (attrNo < 0 || attrNo >= GetHeader()->numOfAttrs) return FAIL;
+
+	PaxAttr *attr = GetAttrs() + attrNo;
+	values = data + attr->minipage;
+	length = attr->length;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// PaxPage::Filter
+//
+// Input    : A condition on an attrInteger or attrReal attribute,
+//            which is found by the offset of its field in the row.
+// Output   : A bitmask of the rows that satisfy it, with
+//            BitmapWords(numOfSlots) words.
+// Purpose  : Evaluate a condition on a numeric attribute of every row
+//            at once, straight over its minipage.
+// Return   : OK if successful, FAIL if no attribute of the condition's
+//            type lies at its offset or the condition is not supported.
+//------------------------------------------------------------------
+
+Status PaxPage::Filter(const Condition& cond, uint *mask)
+{
+	int size = (cond.type == attrReal) ? sizeof(double) : sizeof(int);
+	PaxAttr *attr = GetAttrs();
+	int attrNo = 0;
+	for (; attrNo < GetHeader()->numOfAttrs; attrNo++, attr++) {
+		if (attr->offset == cond.offset) break;
+	}
+	if (attrNo == GetHeader()->numOfAttrs || attr->type != cond.type || attr->length != size) return FAIL;
+
+	Status status = FilterColumn(data + attr->minipage, attr->length, GetHeader()->numOfSlots, cond, mask);
+	if (status != OK) return status;
+
+	AndBits(mask, GetBitmap(), GetHeader()->numOfSlots);       // drop matches in empty rows
+	return OK;
+}
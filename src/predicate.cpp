@@ -0,0 +1,230 @@
+#include <string.h>
+#include <memory.h>
+#include <limits.h>
+
+#include "predicate.h"
+
+using namespace std;
+
+//	Read a constant of the given type out of a Condition value.
+template <class T> static T ConstantOf(const Condition::Value& value);
+template <> int    ConstantOf<int>(const Condition::Value& value)    { return value.intVal; }
+template <> double ConstantOf<double>(const Condition::Value& value) { return value.realVal; }
+
+//	Compare a numeric field. The operator is a template parameter, so each
+//	instance compiles down to a single comparison.
+template <class T, AttrOperator OP>
+static bool CompareNumber(const char *field, const Condition& cond)
+{
+	T value;
+	memcpy(&value, field, sizeof(T));     // fields need not be aligned in the record
+	T low = ConstantOf<T>(cond.low);
+
+	switch (OP) {
+	case aopEQ:   return value == low;
+	case aopNE:   return value != low;
+	case aopLT:   return value < low;
+	case aopGT:   return value > low;
+	case aopLE:   return value <= low;
+	case aopGE:   return value >= low;
+	case opRANGE: return low <= value && value <= ConstantOf<T>(cond.high);
+	default:      return true;
+	}
+}
+
+//	Compare a fixed-length string field, which may be NUL padded.
+template <AttrOperator OP>
+static bool CompareString(const char *field, const Condition& cond)
+{
+	int result = strncmp(field, cond.low.strVal, cond.length);
+
+	switch (OP) {
+	case aopEQ:   return result == 0;
+	case aopNE:   return result != 0;
+	case aopLT:   return result < 0;
+	case aopGT:   return result > 0;
+	case aopLE:   return result <= 0;
+	case aopGE:   return result >= 0;
+	case opRANGE: return result >= 0 && strncmp(field, cond.high.strVal, cond.length) <= 0;
+	default:      return true;
+	}
+}
+
+//	A condition with aopNOP is always satisfied.
+static bool CompareNothing(const char *field, const Condition& cond)
+{
+	return true;
+}
+
+//	Check that a constant given for an attrInteger field is a whole int.
+static bool IsInteger(double value)
+{
+	return value >= INT_MIN && value <= INT_MAX && value == (double)(int)value;
+}
+
+//	Pick the comparison for a numeric type and operator.
+template <class T>
+static CompareFunc PickNumberCompare(AttrOperator op)
+{
+	switch (op) {
+	case aopEQ:   return CompareNumber<T, aopEQ>;
+	case aopNE:   return CompareNumber<T, aopNE>;
+	case aopLT:   return CompareNumber<T, aopLT>;
+	case aopGT:   return CompareNumber<T, aopGT>;
+	case aopLE:   return CompareNumber<T, aopLE>;
+	case aopGE:   return CompareNumber<T, aopGE>;
+	case opRANGE: return CompareNumber<T, opRANGE>;
+	case aopNOP:  return CompareNothing;
+	default:      return NULL;
+	}
+}
+
+//	Pick the comparison for a string operator.
+static CompareFunc PickStringCompare(AttrOperator op)
+{
+	switch (op) {
+	case aopEQ:   return CompareString<aopEQ>;
+	case aopNE:   return CompareString<aopNE>;
+	case aopLT:   return CompareString<aopLT>;
+	case aopGT:   return CompareString<aopGT>;
+	case aopLE:   return CompareString<aopLE>;
+	case aopGE:   return CompareString<aopGE>;
+	case opRANGE: return CompareString<opRANGE>;
+	case aopNOP:  return CompareNothing;
+	default:      return NULL;
+	}
+}
+
+
+//------------------------------------------------------------------
+// Condition::Init
+//
+// Input    : Field offset (and length for strings), the field's type,
+//            operator, the constant to compare against, and the upper
+//            bound for opRANGE.
+// Output   : None.
+// Purpose  : Set up a condition on an integer, real or string field,
+//            picking its comparison. The field's type is given
+//            explicitly, not taken from the type of the constant;
+//            constants for an attrInteger field must be whole numbers.
+// Return   : OK if successful, FAIL if the type does not fit the
+//            constant or the operator is not supported.
+//------------------------------------------------------------------
+
+Status Condition::Init(int off, AttrType attrType, AttrOperator attrOp, double value, double up)
+{
+	if (off < 0) return FAIL;
+
+	if (attrType == attrInteger) {
+		if (!IsInteger(value) || !IsInteger(up)) return FAIL;
+		compare = PickNumberCompare<int>(attrOp);
+		length = sizeof(int);
+		low.intVal = (int)value;
+		high.intVal = (int)up;
+	}
+	else if (attrType == attrReal) {
+		compare = PickNumberCompare<double>(attrOp);
+		length = sizeof(double);
+		low.realVal = value;
+		high.realVal = up;
+	}
+	else return FAIL;
+	if (compare == NULL) return FAIL;   // aopNOT has no meaning on a single field
+
+	offset = off;
+	type = attrType;
+	op = attrOp;
+	return OK;
+}
+
+Status Condition::Init(int off, int len, AttrType attrType, AttrOperator attrOp, const char *value, const char *up)
+{
+	if (off < 0 || len < 0 || attrType != attrString) return FAIL;
+	if (value == NULL || (attrOp == opRANGE && up == NULL)) return FAIL;
+
+	compare = PickStringCompare(attrOp);
+	if (compare == NULL) return FAIL;   // aopNOT has no meaning on a single field
+
+	offset = off;
+	length = len;
+	type = attrType;
+	op = attrOp;
+	low.strVal = value;
+	high.strVal = up;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// Predicate::Predicate
+//
+// Input    : How the conditions are combined, lopAND, lopOR or lopNOT.
+// Output   : None.
+// Purpose  : Create a predicate with no conditions, which every
+//            record satisfies.
+//------------------------------------------------------------------
+
+Predicate::Predicate(LogicalOperator op)
+{
+	lop = op;
+	numOfConds = 0;
+}
+
+Predicate::~Predicate()
+{
+}
+
+
+//------------------------------------------------------------------
+// Predicate::AddCondition
+//
+// Input    : As for Condition::Init.
+// Output   : None.
+// Purpose  : Add a condition on an integer, real or string field.
+// Return   : OK if successful, FAIL if Condition::Init rejects it or
+//            there are already MAX_CONDITIONS conditions.
+//------------------------------------------------------------------
+
+Status Predicate::AddCondition(int offset, AttrType type, AttrOperator op, double value, double high)
+{
+	if (numOfConds == MAX_CONDITIONS) return FAIL;
+
+	Status status = conds[numOfConds].Init(offset, type, op, value, high);
+	if (status == OK) numOfConds++;
+	return status;
+}
+
+Status Predicate::AddCondition(int offset, int length, AttrType type, AttrOperator op,
+                               const char *value, const char *high)
+{
+	if (numOfConds == MAX_CONDITIONS) return FAIL;
+
+	Status status = conds[numOfConds].Init(offset, length, type, op, value, high);
+	if (status == OK) numOfConds++;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Predicate::Matches
+//
+// Input    : Pointer to the record and the record's length.
+// Output   : None.
+// Purpose  : Check if the record satisfies the predicate. A field
+//            that lies past the end of the record fails its condition.
+//            Evaluation stops at the first condition that decides the
+//            result.
+// Return   : true if the record satisfies the predicate.
+//------------------------------------------------------------------
+
+bool Predicate::Matches(const char *recPtr, int recLen) const
+{
+	if (numOfConds == 0) return true;
+
+	bool any = (lop == lopOR);    // the result that stops the evaluation early
+	bool negate = (lop == lopNOT); // lopNOT is the AND of the conditions, negated
+	for (int i = 0; i < numOfConds; i++) {
+		if (conds[i].Matches(recPtr, recLen) == any) return any != negate;
+	}
+	return !any != negate;
+}